@@ -0,0 +1,107 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgCacheFile.cc
+//!  \brief Dwm::FreeBSDPkg::CacheFile class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <unistd.h>
+}
+
+#include <cstdio>
+#include <fstream>
+
+#include "DwmFreeBSDPkgCacheFile.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool CacheFile::Cacheable(const string & s)
+    {
+      return (s.find_first_of("\t\n") == string::npos);
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    vector<string> CacheFile::SplitFields(const string & line)
+    {
+      vector<string>     rc;
+      string::size_type  start = 0, end;
+      while ((end = line.find('\t', start)) != string::npos) {
+        rc.push_back(line.substr(start, end - start));
+        start = end + 1;
+      }
+      rc.push_back(line.substr(start));
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool CacheFile::Write(const string & path,
+                          const function<void(ostream &)> & write)
+    {
+      bool    rc = false;
+      string  tmpPath(path + ".tmp." + to_string(getpid()));
+      {
+        ofstream  os(tmpPath.c_str());
+        if (os) {
+          write(os);
+          os.close();
+          rc = (! os.fail());
+        }
+      }
+      if (rc) {
+        rc = (rename(tmpPath.c_str(), path.c_str()) == 0);
+      }
+      if (! rc) {
+        unlink(tmpPath.c_str());
+      }
+      return rc;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
@@ -0,0 +1,89 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgCacheFile.hh
+//!  \brief Dwm::FreeBSDPkg::CacheFile class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGCACHEFILE_HH_
+#define _DWMFREEBSDPKGCACHEFILE_HH_
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  Helpers shared by the on-disk caches (HashCache, PackageCache and
+    //!  DependencyCache).  Their files are plain text with one entry per
+    //!  line, and are replaced as a whole when saved.
+    //------------------------------------------------------------------------
+    class CacheFile
+    {
+    public:
+      //----------------------------------------------------------------------
+      //!  Fields are separated by tabs, so returns false if @c s contains
+      //!  a tab or a newline and hence can't be cached.
+      //----------------------------------------------------------------------
+      static bool Cacheable(const std::string & s);
+
+      //----------------------------------------------------------------------
+      //!  Returns the tab-separated fields of @c line.
+      //----------------------------------------------------------------------
+      static std::vector<std::string> SplitFields(const std::string & line);
+
+      //----------------------------------------------------------------------
+      //!  Calls @c write to write the contents of the cache file at
+      //!  @c path to a temporary file next to it, then renames the
+      //!  temporary file to @c path, so readers never see a partial
+      //!  file.  Returns true on success.  On failure the temporary file
+      //!  is removed and @c path is left alone.
+      //----------------------------------------------------------------------
+      static bool
+      Write(const std::string & path,
+            const std::function<void(std::ostream &)> & write);
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGCACHEFILE_HH_
@@ -0,0 +1,270 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgDependencyCache.cc
+//!  \brief Dwm::FreeBSDPkg::DependencyCache class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <unistd.h>
+}
+
+#include <cstdlib>
+#include <fstream>
+
+#include "DwmFreeBSDPkgCacheFile.hh"
+#include "DwmFreeBSDPkgDependencyCache.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    static const string  k_magic("mkfbsdmnfst-depcache 1");
+
+    //------------------------------------------------------------------------
+    //!  Returns the identity of the file at @c path as a string, or an
+    //!  empty string if it doesn't exist.
+    //------------------------------------------------------------------------
+    static string FileIdentity(const string & path)
+    {
+      string       rc;
+      struct stat  statbuf;
+      if (stat(path.c_str(), &statbuf) == 0) {
+        int64_t  mtimeNs = ((int64_t)statbuf.st_mtim.tv_sec * 1000000000LL)
+          + statbuf.st_mtim.tv_nsec;
+        rc = to_string((uint64_t)statbuf.st_dev) + ':'
+          + to_string((uint64_t)statbuf.st_ino) + ':'
+          + to_string((uint64_t)statbuf.st_size) + ':' + to_string(mtimeNs);
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Returns a description of everything outside a file that affects
+    //!  which libraries are found for it.
+    //------------------------------------------------------------------------
+    static string Environment()
+    {
+      string  rc("hints=" + FileIdentity("/var/run/ld-elf.so.hints")
+                 + " hints32=" + FileIdentity("/var/run/ld-elf32.so.hints")
+                 + " LD_LIBRARY_PATH=");
+      const char  *ldLibraryPath = getenv("LD_LIBRARY_PATH");
+      if (ldLibraryPath) {
+        rc += ldLibraryPath;
+      }
+      return rc;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    static string Key(const string & digest, mode_t mode)
+    {
+      return (digest + ((mode & S_IXUSR) ? " x" : " -"));
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    static string DirName(const string & path)
+    {
+      string::size_type  slash = path.find_last_of('/');
+      return ((slash == string::npos) ? string(".")
+              : path.substr(0, slash));
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    DependencyCache::DependencyCache(const string & path)
+        : _path(path), _environment(Environment()), _mtx(), _entries(),
+          _hits(0), _misses(0)
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & DependencyCache::Path() const
+    {
+      return _path;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool DependencyCache::Load()
+    {
+      lock_guard<mutex>  lk(_mtx);
+      _entries.clear();
+      ifstream  is(_path.c_str());
+      if (! is) {
+        return (access(_path.c_str(), F_OK) != 0);
+      }
+      bool    rc = false;
+      string  line;
+      if (getline(is, line) && (line == k_magic) && getline(is, line)) {
+        rc = true;
+        if (line != ("env\t" + _environment)) {
+          //  Libraries may be found differently now.
+          return rc;
+        }
+        while (getline(is, line)) {
+          //  digest-and-mode, origin directory, then path and identity
+          //  of each needed file.
+          vector<string>  fields = CacheFile::SplitFields(line);
+          if ((fields.size() < 2) || (fields.size() % 2)) {
+            rc = false;
+            _entries.clear();
+            break;
+          }
+          Entry  entry = { fields[1], {}, false };
+          for (size_t i = 2; i < fields.size(); i += 2) {
+            entry.needed.push_back({ fields[i], fields[i + 1] });
+          }
+          _entries[fields[0]] = std::move(entry);
+        }
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool DependencyCache::Save()
+    {
+      lock_guard<mutex>  lk(_mtx);
+      return CacheFile::Write(_path, [&] (ostream & os) {
+        os << k_magic << '\n' << "env\t" << _environment << '\n';
+        for (const auto & e : _entries) {
+          if (e.second.used) {
+            os << e.first << '\t' << e.second.originDir;
+            for (const auto & needed : e.second.needed) {
+              os << '\t' << needed.path << '\t' << needed.identity;
+            }
+            os << '\n';
+          }
+        }
+      });
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool DependencyCache::Find(const string & digest, mode_t mode,
+                               const string & path, set<string> & needed)
+    {
+      bool   rc = false;
+      Entry  entry;
+      {
+        lock_guard<mutex>  lk(_mtx);
+        auto  it = _entries.find(Key(digest, mode));
+        if (it != _entries.end()) {
+          entry = it->second;
+          rc = true;
+        }
+      }
+      //  Check the needed files without holding the lock, since stat()
+      //  may be slow.
+      if (rc && (! entry.originDir.empty())) {
+        rc = (entry.originDir == DirName(path));
+      }
+      for (auto it = entry.needed.begin(); rc && (it != entry.needed.end());
+           ++it) {
+        rc = (FileIdentity(it->path) == it->identity);
+      }
+      if (rc) {
+        for (const auto & n : entry.needed) {
+          needed.insert(n.path);
+        }
+        lock_guard<mutex>  lk(_mtx);
+        _entries[Key(digest, mode)].used = true;
+        ++_hits;
+      }
+      else {
+        ++_misses;
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void DependencyCache::Add(const string & digest, mode_t mode,
+                              const string & path, bool usesOrigin,
+                              const set<string> & needed)
+    {
+      if (digest.empty() || (! CacheFile::Cacheable(digest))) {
+        return;
+      }
+      Entry  entry = { (usesOrigin ? DirName(path) : string()), {}, true };
+      if (! CacheFile::Cacheable(entry.originDir)) {
+        return;
+      }
+      for (const auto & n : needed) {
+        string  identity = FileIdentity(n);
+        if (identity.empty() || (! CacheFile::Cacheable(n))) {
+          return;
+        }
+        entry.needed.push_back({ n, identity });
+      }
+      lock_guard<mutex>  lk(_mtx);
+      _entries[Key(digest, mode)] = std::move(entry);
+      return;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint64_t DependencyCache::Hits() const
+    {
+      return _hits;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint64_t DependencyCache::Misses() const
+    {
+      return _misses;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
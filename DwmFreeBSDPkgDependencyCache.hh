@@ -0,0 +1,167 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgDependencyCache.hh
+//!  \brief Dwm::FreeBSDPkg::DependencyCache class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGDEPENDENCYCACHE_HH_
+#define _DWMFREEBSDPKGDEPENDENCYCACHE_HH_
+
+extern "C" {
+  #include <sys/types.h>
+  #include <sys/stat.h>
+}
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  A persistent cache of the files needed by a file (its shared
+    //!  libraries, or its interpreter), keyed by the file's content
+    //!  digest and whether it's executable.  An entry also records the
+    //!  identity (device, inode, size and modification time) of each
+    //!  needed file, and is only used if none of them changed.  If the
+    //!  file's DT_RPATH or DT_RUNPATH uses $ORIGIN, the entry is only
+    //!  used for a file in the same directory.  The whole cache is
+    //!  discarded if the ldconfig(8) hints files or LD_LIBRARY_PATH
+    //!  change, since either can change which libraries are found.
+    //!  Results with a library or '#!/usr/bin/env' program that
+    //!  couldn't be found are not added, since installing it would
+    //!  change them without changing any of the recorded files.
+    //!
+    //!  Find() and Add() may be called from several threads at once.
+    //------------------------------------------------------------------------
+    class DependencyCache
+    {
+    public:
+      //----------------------------------------------------------------------
+      //!  Construct for the cache file at @c path.  Does not read it; call
+      //!  Load() for that.
+      //----------------------------------------------------------------------
+      DependencyCache(const std::string & path);
+
+      //----------------------------------------------------------------------
+      //!  Returns the path of the cache file.
+      //----------------------------------------------------------------------
+      const std::string & Path() const;
+
+      //----------------------------------------------------------------------
+      //!  Reads the cache file.  Returns false if it could not be read or
+      //!  has the wrong format, in which case the cache is empty.  A
+      //!  missing cache file, or one saved in a different environment,
+      //!  is not an error.
+      //----------------------------------------------------------------------
+      bool Load();
+
+      //----------------------------------------------------------------------
+      //!  Writes the cache file.  Only entries that were found or added
+      //!  since Load() are written.  The file is replaced atomically.
+      //!  Returns true on success.
+      //----------------------------------------------------------------------
+      bool Save();
+
+      //----------------------------------------------------------------------
+      //!  Looks up the file at @c path with content digest @c digest and
+      //!  mode @c mode.  Returns true and adds the files it needs to
+      //!  @c needed on a hit.
+      //----------------------------------------------------------------------
+      bool Find(const std::string & digest, mode_t mode,
+                const std::string & path, std::set<std::string> & needed);
+
+      //----------------------------------------------------------------------
+      //!  Adds the files @c needed by the file at @c path with content
+      //!  digest @c digest and mode @c mode.  If @c usesOrigin is true,
+      //!  the entry is tied to the directory containing @c path.
+      //----------------------------------------------------------------------
+      void Add(const std::string & digest, mode_t mode,
+               const std::string & path, bool usesOrigin,
+               const std::set<std::string> & needed);
+
+      //----------------------------------------------------------------------
+      //!  Returns the number of successful calls to Find().
+      //----------------------------------------------------------------------
+      uint64_t Hits() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the number of unsuccessful calls to Find().
+      //----------------------------------------------------------------------
+      uint64_t Misses() const;
+      
+    private:
+      //----------------------------------------------------------------------
+      //!  
+      //----------------------------------------------------------------------
+      struct Needed
+      {
+        std::string  path;
+        std::string  identity;
+      };
+
+      //----------------------------------------------------------------------
+      //!  
+      //----------------------------------------------------------------------
+      struct Entry
+      {
+        std::string          originDir;
+        std::vector<Needed>  needed;
+        bool                 used;
+      };
+      
+      std::string                             _path;
+      std::string                             _environment;
+      std::mutex                              _mtx;
+      std::unordered_map<std::string,Entry>   _entries;
+      std::atomic<uint64_t>                   _hits;
+      std::atomic<uint64_t>                   _misses;
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGDEPENDENCYCACHE_HH_
@@ -0,0 +1,343 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgDependencyScanner.cc
+//!  \brief Dwm::FreeBSDPkg::DependencyScanner class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <sys/stat.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "DwmFreeBSDPkgDependencyScanner.hh"
+#include "DwmFreeBSDPkgFileClassifier.hh"
+#include "DwmFreeBSDPkgLibraryResolver.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    namespace {
+
+      typedef chrono::steady_clock  Clock;
+      
+      //----------------------------------------------------------------------
+      //!  State shared by the scanning thread and all workers.  Held by
+      //!  shared_ptr so an abandoned worker that wakes up later never
+      //!  touches freed memory.
+      //----------------------------------------------------------------------
+      struct ScanState
+      {
+        vector<DependencyScanner::File>  files;
+        shared_ptr<DependencyCache>      cache;
+        atomic<size_t>                   next{0};
+        mutex                            doneMtx;
+        condition_variable               doneCv;
+        size_t                           numDone = 0;
+      };
+
+      //----------------------------------------------------------------------
+      //!  A worker's own state.  @c startedNs is the time the current
+      //!  file was started (0 when idle), for the watchdog.  @c needed is
+      //!  only modified between files, with @c mtx held.
+      //----------------------------------------------------------------------
+      struct WorkerState
+      {
+        LibraryResolver      resolver;
+        set<string>          needed;
+        atomic<int64_t>      startedNs{0};
+        atomic<size_t>       current{0};
+        mutex                mtx;
+        bool                 finished = false;
+        bool                 abandoned = false;
+      };
+
+      //----------------------------------------------------------------------
+      //!  
+      //----------------------------------------------------------------------
+      int64_t NowNs()
+      {
+        return chrono::duration_cast<chrono::nanoseconds>
+          (Clock::now().time_since_epoch()).count();
+      }
+      
+      //----------------------------------------------------------------------
+      //!  Adds the files from other packages that @c file needs to
+      //!  @c neededFiles.  Sets @c usesOrigin to true if @c file is an
+      //!  ELF file whose library search path depends on its location
+      //!  ($ORIGIN).  Returns false if a library or a '#!/usr/bin/env'
+      //!  program couldn't be found, since installing it later would
+      //!  change the result.
+      //----------------------------------------------------------------------
+      bool GetNeededFiles(const DependencyScanner::File & file,
+                          LibraryResolver & resolver,
+                          set<string> & neededFiles, bool & usesOrigin)
+      {
+        bool            rc = true;
+        FileClassifier  classifier;
+        usesOrigin = false;
+        if (classifier.Classify(file.path)) {
+          switch (classifier.Type()) {
+            case FileClassifier::e_elfExecutable:
+            case FileClassifier::e_elfSharedObject:
+              if (classifier.Elf().IsDynamic()) {
+                usesOrigin =
+                  ((classifier.Elf().RPath().find("ORIGIN") != string::npos)
+                   || (classifier.Elf().RunPath().find("ORIGIN")
+                       != string::npos));
+                rc = resolver.Resolve(classifier.Elf(), neededFiles);
+              }
+              break;
+            case FileClassifier::e_script:
+              if ((file.mode & S_IXUSR)
+                  && (! classifier.Interpreter().empty())) {
+                neededFiles.insert(classifier.Interpreter());
+                rc = classifier.InterpreterFound();
+              }
+              break;
+            default:
+              break;
+          }
+        }
+        return rc;
+      }
+      
+      //----------------------------------------------------------------------
+      //!  
+      //----------------------------------------------------------------------
+      void Work(shared_ptr<ScanState> scan, shared_ptr<WorkerState> worker)
+      {
+        size_t  i;
+        while ((i = scan->next++) < scan->files.size()) {
+          const DependencyScanner::File  & file = scan->files[i];
+          worker->current = i;
+          worker->startedNs = NowNs();
+          set<string>  needed;
+          bool         cacheable = (scan->cache && (! file.digest.empty()));
+          if ((! cacheable)
+              || (! scan->cache->Find(file.digest, file.mode, file.path,
+                                      needed))) {
+            bool  usesOrigin;
+            if (GetNeededFiles(file, worker->resolver, needed, usesOrigin)
+                && cacheable) {
+              scan->cache->Add(file.digest, file.mode, file.path,
+                               usesOrigin, needed);
+            }
+          }
+          worker->startedNs = 0;
+          lock_guard<mutex>  lk(worker->mtx);
+          if (worker->abandoned) {
+            return;
+          }
+          worker->needed.insert(needed.begin(), needed.end());
+        }
+        {
+          lock_guard<mutex>  lk(worker->mtx);
+          if (worker->abandoned) {
+            return;
+          }
+          worker->finished = true;
+        }
+        {
+          lock_guard<mutex>  lk(scan->doneMtx);
+          ++scan->numDone;
+        }
+        scan->doneCv.notify_all();
+        return;
+      }
+
+    }  // anonymous namespace
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    DependencyScanner::DependencyScanner(unsigned int numThreads,
+                                         unsigned int timeout)
+        : _numThreads(numThreads), _timeout(timeout), _cache(), _timedOut()
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    unsigned int DependencyScanner::NumThreads() const
+    {
+      return _numThreads;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    unsigned int DependencyScanner::NumThreads(unsigned int numThreads)
+    {
+      _numThreads = numThreads;
+      return _numThreads;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    unsigned int DependencyScanner::Timeout() const
+    {
+      return _timeout;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    unsigned int DependencyScanner::Timeout(unsigned int timeout)
+    {
+      _timeout = timeout;
+      return _timeout;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const shared_ptr<DependencyCache> & DependencyScanner::Cache() const
+    {
+      return _cache;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const shared_ptr<DependencyCache> &
+    DependencyScanner::Cache(const shared_ptr<DependencyCache> & cache)
+    {
+      _cache = cache;
+      return _cache;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    set<string> DependencyScanner::Scan(const vector<File> & files)
+    {
+      _timedOut.clear();
+      size_t  numThreads = _numThreads;
+      if (0 == numThreads) {
+        numThreads = max(thread::hardware_concurrency(), 1U);
+      }
+      numThreads = min(numThreads, max(files.size(), (size_t)1));
+
+      auto  scan = make_shared<ScanState>();
+      scan->files = files;
+      scan->cache = _cache;
+      vector<shared_ptr<WorkerState>>  workers;
+      vector<thread>                   threads;
+      auto  startWorker = [&] () {
+        workers.push_back(make_shared<WorkerState>());
+        threads.emplace_back(Work, scan, workers.back());
+      };
+      for (size_t i = 0; i < numThreads; ++i) {
+        startWorker();
+      }
+
+      //  Wait for the workers.  With a timeout, wake up periodically to
+      //  look for workers stuck on one file.  Each one is abandoned and
+      //  replaced.
+      const int64_t  timeoutNs = (int64_t)_timeout * 1000000000LL;
+      size_t         numAbandoned = 0;
+      unique_lock<mutex>  lk(scan->doneMtx);
+      while ((scan->numDone + numAbandoned) < workers.size()) {
+        if (0 == _timeout) {
+          scan->doneCv.wait(lk);
+          continue;
+        }
+        scan->doneCv.wait_for(lk, chrono::milliseconds(100));
+        lk.unlock();
+        int64_t  now = NowNs();
+        for (size_t w = 0, n = workers.size(); w < n; ++w) {
+          shared_ptr<WorkerState>  worker = workers[w];
+          int64_t                  started = worker->startedNs;
+          if (started && ((now - started) > timeoutNs)) {
+            lock_guard<mutex>  wlk(worker->mtx);
+            if ((! worker->finished) && (! worker->abandoned)
+                && (worker->startedNs == started)) {
+              worker->abandoned = true;
+              ++numAbandoned;
+              _timedOut.push_back(scan->files[worker->current].path);
+              startWorker();
+            }
+          }
+        }
+        lk.lock();
+      }
+      lk.unlock();
+
+      //  Abandoned workers never touch their results again, and the
+      //  rest are done, so the results can be merged without contention.
+      set<string>  rc;
+      for (size_t w = 0; w < workers.size(); ++w) {
+        bool  abandoned;
+        {
+          lock_guard<mutex>  wlk(workers[w]->mtx);
+          abandoned = workers[w]->abandoned;
+        }
+        if (abandoned) {
+          threads[w].detach();
+        }
+        else {
+          threads[w].join();
+        }
+        rc.insert(workers[w]->needed.begin(), workers[w]->needed.end());
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const vector<string> & DependencyScanner::TimedOut() const
+    {
+      return _timedOut;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
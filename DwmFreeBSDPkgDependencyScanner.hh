@@ -0,0 +1,152 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgDependencyScanner.hh
+//!  \brief Dwm::FreeBSDPkg::DependencyScanner class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGDEPENDENCYSCANNER_HH_
+#define _DWMFREEBSDPKGDEPENDENCYSCANNER_HH_
+
+extern "C" {
+  #include <sys/types.h>
+}
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "DwmFreeBSDPkgDependencyCache.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  Finds the files from other packages (shared libraries and script
+    //!  interpreters) needed by a set of files, using a pool of worker
+    //!  threads.  Each worker has its own LibraryResolver and result set,
+    //!  so workers never contend with each other; the result sets are
+    //!  merged once the workers are done.
+    //!
+    //!  If the analysis of a single file takes longer than the timeout
+    //!  (e.g. on a hung filesystem), its path is recorded in TimedOut(),
+    //!  the worker is abandoned and a new worker takes its place, so the
+    //!  scan always finishes.
+    //!
+    //!  If a DependencyCache is attached, files with a known content
+    //!  digest are looked up there first and only analyzed on a miss.
+    //------------------------------------------------------------------------
+    class DependencyScanner
+    {
+    public:
+      //----------------------------------------------------------------------
+      //!  A file to scan.
+      //----------------------------------------------------------------------
+      struct File
+      {
+        std::string  path;
+        mode_t       mode;
+        std::string  digest;  //!< content digest, empty if unknown
+      };
+      
+      //----------------------------------------------------------------------
+      //!  Construct with the given number of threads (0 means one per
+      //!  online CPU) and per-file timeout in seconds (0 means none).
+      //----------------------------------------------------------------------
+      DependencyScanner(unsigned int numThreads = 0,
+                        unsigned int timeout = 0);
+
+      //----------------------------------------------------------------------
+      //!  Returns the number of threads to use.
+      //----------------------------------------------------------------------
+      unsigned int NumThreads() const;
+
+      //----------------------------------------------------------------------
+      //!  Sets and returns the number of threads to use.
+      //----------------------------------------------------------------------
+      unsigned int NumThreads(unsigned int numThreads);
+
+      //----------------------------------------------------------------------
+      //!  Returns the per-file timeout, in seconds.
+      //----------------------------------------------------------------------
+      unsigned int Timeout() const;
+
+      //----------------------------------------------------------------------
+      //!  Sets and returns the per-file timeout, in seconds.
+      //----------------------------------------------------------------------
+      unsigned int Timeout(unsigned int timeout);
+
+      //----------------------------------------------------------------------
+      //!  Returns the cache of results, or nullptr if there is none.
+      //----------------------------------------------------------------------
+      const std::shared_ptr<DependencyCache> & Cache() const;
+
+      //----------------------------------------------------------------------
+      //!  Sets and returns the cache of results.  It's shared with the
+      //!  workers, since an abandoned worker may still use it after
+      //!  Scan() returns.
+      //----------------------------------------------------------------------
+      const std::shared_ptr<DependencyCache> &
+      Cache(const std::shared_ptr<DependencyCache> & cache);
+      
+      //----------------------------------------------------------------------
+      //!  Returns the files needed by @c files: the shared libraries
+      //!  (direct and indirect) of ELF executables and shared objects,
+      //!  and the interpreters of executable scripts.
+      //----------------------------------------------------------------------
+      std::set<std::string> Scan(const std::vector<File> & files);
+
+      //----------------------------------------------------------------------
+      //!  Returns the paths whose analysis timed out in the last Scan().
+      //----------------------------------------------------------------------
+      const std::vector<std::string> & TimedOut() const;
+
+    private:
+      unsigned int                      _numThreads;
+      unsigned int                      _timeout;
+      std::shared_ptr<DependencyCache>  _cache;
+      std::vector<std::string>          _timedOut;
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGDEPENDENCYSCANNER_HH_
@@ -0,0 +1,361 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgElfFile.cc
+//!  \brief Dwm::FreeBSDPkg::ElfFile class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <elf.h>
+  #include <fcntl.h>
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+}
+
+#include <cstring>
+
+#include "DwmFreeBSDPkgElfFile.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    //  Sanity limit on the size of the dynamic string table and the
+    //  program interpreter path we're willing to read.
+    static const uint64_t  k_maxStrTabSize = 16 * 1024 * 1024;
+    static const uint64_t  k_maxInterpSize = 4096;
+    
+    //------------------------------------------------------------------------
+    //!  Returns @c value in host byte order, given whether or not the
+    //!  file's byte order differs from the host's.
+    //------------------------------------------------------------------------
+    template <typename T>
+    static T Host(T value, bool swap)
+    {
+      if (! swap) {
+        return value;
+      }
+      T  rc;
+      const unsigned char  *src = (const unsigned char *)&value;
+      unsigned char        *dst = (unsigned char *)&rc;
+      for (size_t i = 0; i < sizeof(T); ++i) {
+        dst[i] = src[sizeof(T) - 1 - i];
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Reads exactly @c len bytes at @c offset.
+    //------------------------------------------------------------------------
+    static bool ReadAt(int fd, uint64_t offset, void *buf, size_t len)
+    {
+      char  *p = (char *)buf;
+      while (len) {
+        ssize_t  n = pread(fd, p, len, offset);
+        if (n <= 0) {
+          return false;
+        }
+        p += n;
+        offset += n;
+        len -= n;
+      }
+      return true;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    ElfFile::ElfFile()
+        : _path(), _class(ELFCLASSNONE), _type(ET_NONE), _machine(EM_NONE),
+          _dynamic(false), _interpreter(), _needed(), _runPath(), _rPath()
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool ElfFile::Read(const string & path)
+    {
+      *this = ElfFile();
+      _path = path;
+      
+      bool  rc = false;
+      int   fd = open(path.c_str(), O_RDONLY|O_CLOEXEC);
+      if (fd >= 0) {
+        struct stat    statbuf;
+        unsigned char  ident[EI_NIDENT];
+        if ((fstat(fd, &statbuf) == 0)
+            && ReadAt(fd, 0, ident, sizeof(ident))
+            && (memcmp(ident, ELFMAG, SELFMAG) == 0)) {
+          bool  swap;
+#if BYTE_ORDER == LITTLE_ENDIAN
+          swap = (ELFDATA2MSB == ident[EI_DATA]);
+#else
+          swap = (ELFDATA2LSB == ident[EI_DATA]);
+#endif
+          _class = ident[EI_CLASS];
+          if (ELFCLASS64 == _class) {
+            rc = ReadClass<Elf64_Ehdr,Elf64_Phdr,Elf64_Dyn>(fd,
+                                                            statbuf.st_size,
+                                                            swap);
+          }
+          else if (ELFCLASS32 == _class) {
+            rc = ReadClass<Elf32_Ehdr,Elf32_Phdr,Elf32_Dyn>(fd,
+                                                            statbuf.st_size,
+                                                            swap);
+          }
+        }
+        close(fd);
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & ElfFile::Path() const
+    {
+      return _path;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint8_t ElfFile::Class() const
+    {
+      return _class;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint16_t ElfFile::Type() const
+    {
+      return _type;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint16_t ElfFile::Machine() const
+    {
+      return _machine;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool ElfFile::IsDynamic() const
+    {
+      return _dynamic;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & ElfFile::Interpreter() const
+    {
+      return _interpreter;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const vector<string> & ElfFile::Needed() const
+    {
+      return _needed;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & ElfFile::RunPath() const
+    {
+      return _runPath;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & ElfFile::RPath() const
+    {
+      return _rPath;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Reads the program headers to find PT_INTERP and PT_DYNAMIC, then
+    //!  the dynamic section.  DT_STRTAB is a virtual address, so it is
+    //!  mapped back to a file offset through the PT_LOAD segments.
+    //------------------------------------------------------------------------
+    template <typename Ehdr, typename Phdr, typename Dyn>
+    bool ElfFile::ReadClass(int fd, uint64_t fileSize, bool swap)
+    {
+      Ehdr  ehdr;
+      if (! ReadAt(fd, 0, &ehdr, sizeof(ehdr))) {
+        return false;
+      }
+      _type = Host(ehdr.e_type, swap);
+      _machine = Host(ehdr.e_machine, swap);
+      uint64_t  phoff = Host(ehdr.e_phoff, swap);
+      uint16_t  phnum = Host(ehdr.e_phnum, swap);
+      if (0 == phnum) {
+        return true;
+      }
+      if ((Host(ehdr.e_phentsize, swap) != sizeof(Phdr))
+          || (phoff > fileSize)
+          || ((phnum * sizeof(Phdr)) > (fileSize - phoff))) {
+        return false;
+      }
+      vector<Phdr>  phdrs(phnum);
+      if (! ReadAt(fd, phoff, phdrs.data(), phnum * sizeof(Phdr))) {
+        return false;
+      }
+      
+      uint64_t  dynOffset = 0, dynSize = 0;
+      for (const auto & phdr : phdrs) {
+        uint32_t  type = Host(phdr.p_type, swap);
+        uint64_t  offset = Host(phdr.p_offset, swap);
+        uint64_t  size = Host(phdr.p_filesz, swap);
+        if ((offset > fileSize) || (size > (fileSize - offset))) {
+          continue;
+        }
+        if (PT_DYNAMIC == type) {
+          _dynamic = true;
+          dynOffset = offset;
+          dynSize = size;
+        }
+        else if ((PT_INTERP == type) && (size > 0)
+                 && (size <= k_maxInterpSize)) {
+          string  interp(size, '\0');
+          if (ReadAt(fd, offset, &interp[0], size)) {
+            _interpreter = interp.c_str();
+          }
+        }
+      }
+      if (! _dynamic) {
+        return true;
+      }
+
+      vector<Dyn>  dyns(dynSize / sizeof(Dyn));
+      if (! ReadAt(fd, dynOffset, dyns.data(), dyns.size() * sizeof(Dyn))) {
+        return false;
+      }
+      vector<uint64_t>  neededOffsets;
+      uint64_t  runPathOffset = 0, rPathOffset = 0;
+      bool      haveRunPath = false, haveRPath = false;
+      uint64_t  strTabAddr = 0, strTabSize = 0;
+      for (const auto & dyn : dyns) {
+        int64_t   tag = Host(dyn.d_tag, swap);
+        uint64_t  val = Host(dyn.d_un.d_val, swap);
+        if (DT_NULL == tag) {
+          break;
+        }
+        switch (tag) {
+          case DT_NEEDED:
+            neededOffsets.push_back(val);
+            break;
+          case DT_RUNPATH:
+            runPathOffset = val;
+            haveRunPath = true;
+            break;
+          case DT_RPATH:
+            rPathOffset = val;
+            haveRPath = true;
+            break;
+          case DT_STRTAB:
+            strTabAddr = val;
+            break;
+          case DT_STRSZ:
+            strTabSize = val;
+            break;
+          default:
+            break;
+        }
+      }
+      if (neededOffsets.empty() && (! haveRunPath) && (! haveRPath)) {
+        return true;
+      }
+      
+      uint64_t  strTabOffset = 0;
+      bool      mapped = false;
+      for (const auto & phdr : phdrs) {
+        if (Host(phdr.p_type, swap) == PT_LOAD) {
+          uint64_t  vaddr = Host(phdr.p_vaddr, swap);
+          uint64_t  size = Host(phdr.p_filesz, swap);
+          if ((strTabAddr >= vaddr) && ((strTabAddr - vaddr) < size)) {
+            strTabOffset = Host(phdr.p_offset, swap) + (strTabAddr - vaddr);
+            mapped = true;
+            break;
+          }
+        }
+      }
+      if ((! mapped) || (strTabOffset >= fileSize)
+          || (strTabSize > k_maxStrTabSize)) {
+        return false;
+      }
+      if (strTabSize > (fileSize - strTabOffset)) {
+        strTabSize = fileSize - strTabOffset;
+      }
+      string  strTab(strTabSize, '\0');
+      if (! ReadAt(fd, strTabOffset, &strTab[0], strTabSize)) {
+        return false;
+      }
+      auto  str = [&strTab] (uint64_t offset) {
+        return ((offset < strTab.size())
+                ? string(strTab.c_str() + offset) : string());
+      };
+      for (auto offset : neededOffsets) {
+        string  needed = str(offset);
+        if (! needed.empty()) {
+          _needed.push_back(needed);
+        }
+      }
+      if (haveRunPath) {
+        _runPath = str(runPathOffset);
+      }
+      if (haveRPath) {
+        _rPath = str(rPathOffset);
+      }
+      return true;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
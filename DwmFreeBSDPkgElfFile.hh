@@ -0,0 +1,138 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgElfFile.hh
+//!  \brief Dwm::FreeBSDPkg::ElfFile class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGELFFILE_HH_
+#define _DWMFREEBSDPKGELFFILE_HH_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  The parts of an ELF file that matter for finding its shared
+    //!  library dependencies, read directly from the file's program
+    //!  headers and dynamic section.  Handles 32-bit and 64-bit files of
+    //!  either byte order, so it works on binaries for other
+    //!  architectures too.
+    //------------------------------------------------------------------------
+    class ElfFile
+    {
+    public:
+      ElfFile();
+
+      //----------------------------------------------------------------------
+      //!  Reads the ELF file at @c path.  Returns false if it isn't an
+      //!  ELF file or is malformed.
+      //----------------------------------------------------------------------
+      bool Read(const std::string & path);
+
+      //----------------------------------------------------------------------
+      //!  Returns the path given to Read().
+      //----------------------------------------------------------------------
+      const std::string & Path() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns ELFCLASS32 or ELFCLASS64.
+      //----------------------------------------------------------------------
+      uint8_t Class() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the file type (e_type), e.g. ET_EXEC or ET_DYN.
+      //----------------------------------------------------------------------
+      uint16_t Type() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the machine (e_machine), e.g. EM_X86_64.
+      //----------------------------------------------------------------------
+      uint16_t Machine() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns true if the file has a dynamic section.
+      //----------------------------------------------------------------------
+      bool IsDynamic() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the program interpreter (PT_INTERP), if any.
+      //----------------------------------------------------------------------
+      const std::string & Interpreter() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the DT_NEEDED entries, in order.
+      //----------------------------------------------------------------------
+      const std::vector<std::string> & Needed() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns DT_RUNPATH (a colon-separated list of directories), or
+      //!  an empty string if there is none.
+      //----------------------------------------------------------------------
+      const std::string & RunPath() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns DT_RPATH (a colon-separated list of directories), or an
+      //!  empty string if there is none.
+      //----------------------------------------------------------------------
+      const std::string & RPath() const;
+
+    private:
+      std::string               _path;
+      uint8_t                   _class;
+      uint16_t                  _type;
+      uint16_t                  _machine;
+      bool                      _dynamic;
+      std::string               _interpreter;
+      std::vector<std::string>  _needed;
+      std::string               _runPath;
+      std::string               _rPath;
+
+      template <typename Ehdr, typename Phdr, typename Dyn>
+      bool ReadClass(int fd, uint64_t fileSize, bool swap);
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGELFFILE_HH_
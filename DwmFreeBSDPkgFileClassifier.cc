@@ -0,0 +1,204 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgFileClassifier.cc
+//!  \brief Dwm::FreeBSDPkg::FileClassifier class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <elf.h>
+  #include <fcntl.h>
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+}
+
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include "DwmFreeBSDPkgFileClassifier.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    //  How much of a file we read to classify it.  Long enough for any
+    //  reasonable '#!' line.
+    static const size_t  k_headSize = 1024;
+
+    //  Where we look for the program in '#!/usr/bin/env prog'; the
+    //  default PATH from login.conf(5).
+    static const char   *k_defaultPath[] = {
+      "/sbin", "/bin", "/usr/sbin", "/usr/bin", "/usr/local/sbin",
+      "/usr/local/bin"
+    };
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    FileClassifier::FileClassifier()
+        : _type(e_other), _elf(), _interpreter(), _interpreterFound(true)
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool FileClassifier::Classify(const string & path)
+    {
+      _type = e_other;
+      _elf = ElfFile();
+      _interpreter.clear();
+      _interpreterFound = true;
+      
+      int  fd = open(path.c_str(), O_RDONLY|O_CLOEXEC);
+      if (fd < 0) {
+        return false;
+      }
+      char     head[k_headSize];
+      ssize_t  len = pread(fd, head, sizeof(head), 0);
+      close(fd);
+      if (len < 0) {
+        return false;
+      }
+      if ((len >= SELFMAG) && (memcmp(head, ELFMAG, SELFMAG) == 0)) {
+        if (_elf.Read(path)) {
+          switch (_elf.Type()) {
+            case ET_EXEC:
+              _type = e_elfExecutable;
+              break;
+            case ET_DYN:
+              //  A PIE executable is ET_DYN too, but has an interpreter.
+              _type = (_elf.Interpreter().empty() ? e_elfSharedObject
+                       : e_elfExecutable);
+              break;
+            default:
+              _type = e_elfOther;
+              break;
+          }
+        }
+      }
+      else if ((len >= 2) && ('#' == head[0]) && ('!' == head[1])) {
+        _type = e_script;
+        const char  *end = (const char *)memchr(head, '\n', len);
+        ParseShebang(string((const char *)head + 2,
+                            end ? end : ((const char *)head + len)));
+      }
+      return true;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    FileClassifier::FileType FileClassifier::Type() const
+    {
+      return _type;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const ElfFile & FileClassifier::Elf() const
+    {
+      return _elf;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & FileClassifier::Interpreter() const
+    {
+      return _interpreter;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool FileClassifier::InterpreterFound() const
+    {
+      return _interpreterFound;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Sets _interpreter from the part of a '#!' line after the '#!'.
+    //!  For env(1), skips options and variable assignments to find the
+    //!  program, as env would.
+    //------------------------------------------------------------------------
+    void FileClassifier::ParseShebang(const string & line)
+    {
+      istringstream   is(line);
+      vector<string>  words;
+      string          word;
+      while (is >> word) {
+        words.push_back(word);
+      }
+      if (words.empty()) {
+        return;
+      }
+      _interpreter = words[0];
+      size_t  slash = _interpreter.find_last_of('/');
+      if (_interpreter.substr(slash == string::npos ? 0 : slash + 1)
+          != "env") {
+        return;
+      }
+      for (size_t i = 1; i < words.size(); ++i) {
+        if (('-' == words[i][0]) || (words[i].find('=') != string::npos)) {
+          continue;
+        }
+        if (words[i].find('/') != string::npos) {
+          _interpreter = words[i];
+          return;
+        }
+        for (const char *dir : k_defaultPath) {
+          string  path(string(dir) + '/' + words[i]);
+          if (access(path.c_str(), X_OK) == 0) {
+            _interpreter = path;
+            return;
+          }
+        }
+        _interpreterFound = false;
+        break;
+      }
+      return;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
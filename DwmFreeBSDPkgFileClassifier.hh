@@ -0,0 +1,115 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgFileClassifier.hh
+//!  \brief Dwm::FreeBSDPkg::FileClassifier class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGFILECLASSIFIER_HH_
+#define _DWMFREEBSDPKGFILECLASSIFIER_HH_
+
+#include <string>
+
+#include "DwmFreeBSDPkgElfFile.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  Classifies a file by its first bytes rather than its name or
+    //!  mode, so the dependency scan only looks at files that can have
+    //!  dependencies.
+    //------------------------------------------------------------------------
+    class FileClassifier
+    {
+    public:
+      typedef enum {
+        e_other,              //!< anything else
+        e_elfExecutable,      //!< ELF executable, including PIE
+        e_elfSharedObject,    //!< ELF shared object
+        e_elfOther,           //!< other ELF file (e.g. relocatable object)
+        e_script              //!< starts with '#!'
+      } FileType;
+      
+      FileClassifier();
+
+      //----------------------------------------------------------------------
+      //!  Classifies the file at @c path.  Returns false if it could not
+      //!  be read.
+      //----------------------------------------------------------------------
+      bool Classify(const std::string & path);
+
+      //----------------------------------------------------------------------
+      //!  Returns the type of the last file classified.
+      //----------------------------------------------------------------------
+      FileType Type() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the ELF file, if Type() is one of the ELF types.
+      //----------------------------------------------------------------------
+      const ElfFile & Elf() const;
+
+      //----------------------------------------------------------------------
+      //!  If Type() is e_script, returns the path of the interpreter from
+      //!  the '#!' line.  For '#!/usr/bin/env prog', this is the path of
+      //!  'prog' found in the default PATH, if there is one.
+      //----------------------------------------------------------------------
+      const std::string & Interpreter() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns false if Type() is e_script and the '#!' line is
+      //!  '#!/usr/bin/env prog' but 'prog' wasn't found in the default
+      //!  PATH, in which case Interpreter() is env itself.
+      //----------------------------------------------------------------------
+      bool InterpreterFound() const;
+
+    private:
+      FileType     _type;
+      ElfFile      _elf;
+      std::string  _interpreter;
+      bool         _interpreterFound;
+
+      void ParseShebang(const std::string & line);
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGFILECLASSIFIER_HH_
@@ -0,0 +1,405 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgFileHasher.cc
+//!  \brief Dwm::FreeBSDPkg::FileHasher class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <aio.h>
+  #include <errno.h>
+  #include <fcntl.h>
+  #include <openssl/evp.h>
+  #include <openssl/opensslv.h>
+  #include <openssl/sha.h>
+  #include <sys/types.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include "DwmFreeBSDPkgFileHasher.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    static const size_t  k_readBufSize = 65536;
+    static const size_t  k_aioBufSize = 256 * 1024;
+    static const size_t  k_aioQueueDepth = 4;
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    static string HexString(const unsigned char *md, size_t mdLen)
+    {
+      ostringstream  os;
+      os << setfill('0') << hex;
+      for (size_t i = 0; i < mdLen; ++i) {
+        os << setw(2) << (uint16_t)md[i];
+      }
+      return os.str();
+    }
+    
+    //------------------------------------------------------------------------
+    //!  Returns the SHA-256 implementation.  OpenSSL selects the fastest
+    //!  kernel for the running CPU (SHA-NI, AVX2, AVX, SSSE3 on x86_64;
+    //!  the SHA2 extensions on arm64) when it initializes, so we get the
+    //!  hardware path for free as long as we go through EVP.  With
+    //!  OpenSSL 3 we explicitly fetch the digest once instead of letting
+    //!  every EVP_DigestInit_ex() call do an implicit fetch.
+    //------------------------------------------------------------------------
+    static const EVP_MD *SHA256Digest()
+    {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+      static const EVP_MD  *md = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+      return (md ? md : EVP_sha256());
+#else
+      return EVP_sha256();
+#endif
+    }
+    
+    //------------------------------------------------------------------------
+    //!  Per-thread hashing state.  Created once per worker and reused for
+    //!  every file the worker hashes.
+    //------------------------------------------------------------------------
+    class HashWorker
+    {
+    public:
+      HashWorker(uint64_t mmapThreshold, bool asyncReads)
+          : _ctx(EVP_MD_CTX_new()), _buf(new uint8_t[k_readBufSize]),
+            _mmapThreshold(mmapThreshold), _aioBufs()
+      {
+        if (asyncReads) {
+          _aioBufs.reset(new uint8_t[k_aioBufSize * k_aioQueueDepth]);
+        }
+      }
+
+      ~HashWorker()
+      {
+        if (_ctx) {
+          EVP_MD_CTX_free(_ctx);
+        }
+      }
+
+      HashWorker(const HashWorker &) = delete;
+      HashWorker & operator = (const HashWorker &) = delete;
+      
+      string HashFile(const string & path)
+      {
+        string  rc;
+        int     fd = open(path.c_str(), O_RDONLY|O_NOFOLLOW);
+        if ((fd < 0) && ((ELOOP == errno) || (EMLINK == errno))) {
+          //  A symlink (FreeBSD says EMLINK, others ELOOP).
+          return HashSymlink(path);
+        }
+        if (fd >= 0) {
+          if (_ctx && EVP_DigestInit_ex(_ctx, SHA256Digest(), nullptr)) {
+            unsigned char  md[SHA256_DIGEST_LENGTH];
+            if (UpdateFromMapping(fd)
+                || (_aioBufs ? UpdateFromAsyncReads(fd)
+                    : UpdateFromReads(fd))) {
+              if (EVP_DigestFinal_ex(_ctx, &(md[0]), nullptr)) {
+                rc = HexString(md, sizeof(md));
+              }
+            }
+          }
+          close(fd);
+        }
+        return rc;
+      }
+
+      //----------------------------------------------------------------------
+      //!  Returns the digest of the symlink at @c path the way pkg(8)
+      //!  computes it: the digest of the link's target as returned by
+      //!  readlink(), without a leading '/'.  The target itself is never
+      //!  read, so absolute and dangling links get the same digest on
+      //!  every host.
+      //----------------------------------------------------------------------
+      string HashSymlink(const string & path)
+      {
+        string   rc;
+        ssize_t  len = readlink(path.c_str(), (char *)_buf.get(),
+                                k_readBufSize);
+        if ((len >= 0) && ((size_t)len < k_readBufSize)) {
+          const uint8_t  *target = _buf.get();
+          if ((len > 0) && ('/' == target[0])) {
+            ++target;
+            --len;
+          }
+          unsigned char  md[SHA256_DIGEST_LENGTH];
+          if (_ctx && EVP_DigestInit_ex(_ctx, SHA256Digest(), nullptr)
+              && EVP_DigestUpdate(_ctx, target, len)
+              && EVP_DigestFinal_ex(_ctx, &(md[0]), nullptr)) {
+            rc = HexString(md, sizeof(md));
+          }
+        }
+        return rc;
+      }
+      
+    private:
+      EVP_MD_CTX                 *_ctx;
+      std::unique_ptr<uint8_t[]>  _buf;
+      uint64_t                    _mmapThreshold;
+      std::unique_ptr<uint8_t[]>  _aioBufs;
+
+      //----------------------------------------------------------------------
+      //!  Feeds the whole file to the digest through a private read-only
+      //!  mapping, if the file is large enough.  Returns false if the
+      //!  file was not mapped, in which case nothing was fed to the
+      //!  digest.
+      //----------------------------------------------------------------------
+      bool UpdateFromMapping(int fd)
+      {
+        bool  rc = false;
+        if (_mmapThreshold) {
+          struct stat  statbuf;
+          if ((fstat(fd, &statbuf) == 0) && S_ISREG(statbuf.st_mode)
+              && (statbuf.st_size > 0)
+              && ((uint64_t)statbuf.st_size >= _mmapThreshold)) {
+            size_t  len = statbuf.st_size;
+            void    *addr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE,
+                                 fd, 0);
+            if (addr != MAP_FAILED) {
+              posix_madvise(addr, len, POSIX_MADV_SEQUENTIAL);
+              EVP_DigestUpdate(_ctx, addr, len);
+              munmap(addr, len);
+              rc = true;
+            }
+          }
+        }
+        return rc;
+      }
+
+      //----------------------------------------------------------------------
+      //!  Feeds the file to the digest with read().  Returns false on a
+      //!  read error.
+      //----------------------------------------------------------------------
+      bool UpdateFromReads(int fd)
+      {
+        ssize_t  bytesRead;
+        while ((bytesRead = read(fd, _buf.get(), k_readBufSize)) > 0) {
+          EVP_DigestUpdate(_ctx, _buf.get(), bytesRead);
+        }
+        return (0 == bytesRead);
+      }
+
+      //----------------------------------------------------------------------
+      //!  Feeds the file to the digest, keeping up to k_aioQueueDepth
+      //!  aio_read() requests in flight and digesting them in file order
+      //!  as they complete.  The first chunk is read with read() so that
+      //!  small files, which are the vast majority, never pay for AIO
+      //!  setup.  If a request can't be submitted, the requests already
+      //!  in flight are drained and the rest of the file is read with
+      //!  read().  Returns false on a read error.
+      //----------------------------------------------------------------------
+      bool UpdateFromAsyncReads(int fd)
+      {
+        ssize_t  bytesRead = read(fd, _aioBufs.get(), k_aioBufSize);
+        if (bytesRead < 0) {
+          return false;
+        }
+        EVP_DigestUpdate(_ctx, _aioBufs.get(), bytesRead);
+        if ((size_t)bytesRead < k_aioBufSize) {
+          return UpdateFromReads(fd);
+        }
+        
+        struct aiocb  cbs[k_aioQueueDepth];
+        off_t         nextOffset = bytesRead;
+        size_t        head = 0, inFlight = 0;
+        bool          rc = true, eof = false, async = true;
+        
+        auto  submit = [&] () {
+          size_t  slot = (head + inFlight) % k_aioQueueDepth;
+          memset(&cbs[slot], 0, sizeof(cbs[slot]));
+          cbs[slot].aio_fildes = fd;
+          cbs[slot].aio_buf = _aioBufs.get() + (slot * k_aioBufSize);
+          cbs[slot].aio_nbytes = k_aioBufSize;
+          cbs[slot].aio_offset = nextOffset;
+          if (aio_read(&cbs[slot]) == 0) {
+            nextOffset += k_aioBufSize;
+            ++inFlight;
+          }
+          else {
+            async = false;
+          }
+        };
+
+        while (async && (inFlight < k_aioQueueDepth)) {
+          submit();
+        }
+        while (inFlight) {
+          struct aiocb        *cb = &cbs[head];
+          const struct aiocb  *waitList[1] = { cb };
+          int                  err;
+          while ((err = aio_error(cb)) == EINPROGRESS) {
+            aio_suspend(waitList, 1, nullptr);
+          }
+          bytesRead = aio_return(cb);
+          head = (head + 1) % k_aioQueueDepth;
+          --inFlight;
+          if ((err != 0) || (bytesRead < 0)) {
+            rc = false;
+          }
+          else if (rc && (! eof)) {
+            EVP_DigestUpdate(_ctx, (const void *)cb->aio_buf, bytesRead);
+          }
+          if ((size_t)bytesRead < k_aioBufSize) {
+            eof = true;
+          }
+          if (rc && async && (! eof)) {
+            submit();
+          }
+        }
+        if (rc && (! eof)) {
+          rc = ((lseek(fd, nextOffset, SEEK_SET) == nextOffset)
+                && UpdateFromReads(fd));
+        }
+        return rc;
+      }
+    };
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    FileHasher::FileHasher(unsigned int numThreads)
+        : _numThreads(0), _mmapThreshold(k_defaultMmapThreshold),
+          _asyncReads(false)
+    {
+      NumThreads(numThreads);
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    unsigned int FileHasher::NumThreads() const
+    {
+      return _numThreads;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    unsigned int FileHasher::NumThreads(unsigned int numThreads)
+    {
+      _numThreads = numThreads;
+      if (0 == _numThreads) {
+        _numThreads = std::max(thread::hardware_concurrency(), 1U);
+      }
+      return _numThreads;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint64_t FileHasher::MmapThreshold() const
+    {
+      return _mmapThreshold;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint64_t FileHasher::MmapThreshold(uint64_t mmapThreshold)
+    {
+      _mmapThreshold = mmapThreshold;
+      return _mmapThreshold;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool FileHasher::AsyncReads() const
+    {
+      return _asyncReads;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool FileHasher::AsyncReads(bool asyncReads)
+    {
+      _asyncReads = asyncReads;
+      return _asyncReads;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  Workers pull the index of the next file from a shared atomic
+    //!  counter and store each digest in the slot with the same index,
+    //!  which keeps the output order independent of scheduling.
+    //------------------------------------------------------------------------
+    vector<string> FileHasher::Hash(const vector<string> & paths) const
+    {
+      vector<string>  rc(paths.size());
+      atomic<size_t>  nextIdx(0);
+      auto  work = [&] () {
+        HashWorker  worker(_mmapThreshold, _asyncReads);
+        size_t      idx;
+        while ((idx = nextIdx.fetch_add(1)) < paths.size()) {
+          rc[idx] = worker.HashFile(paths[idx]);
+        }
+      };
+
+      size_t  numThreads = std::min((size_t)_numThreads, paths.size());
+      if (numThreads <= 1) {
+        work();
+      }
+      else {
+        vector<thread>  threads;
+        for (size_t i = 0; i < numThreads; ++i) {
+          threads.emplace_back(work);
+        }
+        for (auto & t : threads) {
+          t.join();
+        }
+      }
+      return rc;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
@@ -0,0 +1,137 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgFileHasher.hh
+//!  \brief Dwm::FreeBSDPkg::FileHasher class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGFILEHASHER_HH_
+#define _DWMFREEBSDPKGFILEHASHER_HH_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  Computes the SHA-256 digests of many files using a pool of worker
+    //!  threads.
+    //!  Each worker owns one digest context and one read buffer for its
+    //!  whole lifetime, so there is no per-file setup cost beyond open()
+    //!  and close().  Results are always returned in the order of the
+    //!  input paths, regardless of the number of threads.
+    //------------------------------------------------------------------------
+    class FileHasher
+    {
+    public:
+      //----------------------------------------------------------------------
+      //!  Construct with the given number of worker threads.  A value of
+      //!  0 means one thread per online CPU.
+      //----------------------------------------------------------------------
+      FileHasher(unsigned int numThreads = 0);
+
+      //----------------------------------------------------------------------
+      //!  Returns the number of worker threads.
+      //----------------------------------------------------------------------
+      unsigned int NumThreads() const;
+
+      //----------------------------------------------------------------------
+      //!  Sets and returns the number of worker threads.  A value of 0
+      //!  means one thread per online CPU.
+      //----------------------------------------------------------------------
+      unsigned int NumThreads(unsigned int numThreads);
+
+      //----------------------------------------------------------------------
+      //!  Returns the size at or above which a file is hashed through a
+      //!  read-only memory mapping instead of read().  0 means never.
+      //----------------------------------------------------------------------
+      uint64_t MmapThreshold() const;
+
+      //----------------------------------------------------------------------
+      //!  Sets and returns the size at or above which a file is hashed
+      //!  through a read-only memory mapping instead of read().  0 means
+      //!  never.  Mapping avoids copying every byte into a user-space
+      //!  buffer, which matters for multi-gigabyte files but is slower
+      //!  than read() for small ones.
+      //----------------------------------------------------------------------
+      uint64_t MmapThreshold(uint64_t mmapThreshold);
+
+      //----------------------------------------------------------------------
+      //!  Returns true if files are read with asynchronous I/O.
+      //----------------------------------------------------------------------
+      bool AsyncReads() const;
+
+      //----------------------------------------------------------------------
+      //!  Sets and returns whether files are read with POSIX asynchronous
+      //!  I/O.  When true, each worker keeps several reads of the file it
+      //!  is hashing in flight while it digests the data that has already
+      //!  arrived, which keeps deep device queues (e.g. NVMe) busy.  If
+      //!  aio_read() is unavailable or fails, the worker quietly falls
+      //!  back to read().
+      //----------------------------------------------------------------------
+      bool AsyncReads(bool asyncReads);
+      
+      //----------------------------------------------------------------------
+      //!  Returns the hex SHA-256 digests of the files at the given
+      //!  @c paths, in the same order as @c paths.  Symlinks are not
+      //!  followed; like pkg(8), the digest of a symlink is that of its
+      //!  target path, without a leading '/'.  The digest of a file
+      //!  that could not be read is an empty string, so that no bogus
+      //!  checksum is ever emitted for it.
+      //----------------------------------------------------------------------
+      std::vector<std::string>
+      Hash(const std::vector<std::string> & paths) const;
+
+      //----------------------------------------------------------------------
+      //!  The default for MmapThreshold().
+      //----------------------------------------------------------------------
+      static const uint64_t  k_defaultMmapThreshold = 16 * 1024 * 1024;
+      
+    private:
+      unsigned int  _numThreads;
+      uint64_t      _mmapThreshold;
+      bool          _asyncReads;
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGFILEHASHER_HH_
@@ -0,0 +1,230 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgHashCache.cc
+//!  \brief Dwm::FreeBSDPkg::HashCache class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <time.h>
+  #include <unistd.h>
+}
+
+#include <fstream>
+#include <sstream>
+
+#include "DwmFreeBSDPkgCacheFile.hh"
+#include "DwmFreeBSDPkgHashCache.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    static const string  k_magic("mkfbsdmnfst-hashcache 1");
+
+    //------------------------------------------------------------------------
+    //!  Files whose timestamps are within this many nanoseconds of the
+    //!  start of the run are not cached, since a change made in the same
+    //!  timestamp granule would go unnoticed.
+    //------------------------------------------------------------------------
+    static const int64_t  k_racyWindowNs = 2000000000LL;
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    static int64_t TimespecNs(const struct timespec & ts)
+    {
+      return ((int64_t)ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    HashCache::Key::Key(const struct stat & statbuf)
+        : dev(statbuf.st_dev), ino(statbuf.st_ino), size(statbuf.st_size),
+          mtimeNs(TimespecNs(statbuf.st_mtim)),
+          ctimeNs(TimespecNs(statbuf.st_ctim))
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool HashCache::Key::operator == (const Key & key) const
+    {
+      return ((dev == key.dev) && (ino == key.ino) && (size == key.size)
+              && (mtimeNs == key.mtimeNs) && (ctimeNs == key.ctimeNs));
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    size_t HashCache::KeyHash::operator () (const Key & key) const
+    {
+      uint64_t  h = key.ino;
+      h = (h * 0x9e3779b97f4a7c15ULL) ^ key.dev;
+      h = (h * 0x9e3779b97f4a7c15ULL) ^ (uint64_t)key.mtimeNs;
+      return h;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    HashCache::HashCache(const string & path)
+        : _path(path), _entries(), _startTimeNs(0), _hits(0), _misses(0)
+    {
+      struct timespec  now;
+      if (clock_gettime(CLOCK_REALTIME, &now) == 0) {
+        _startTimeNs = TimespecNs(now);
+      }
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & HashCache::Path() const
+    {
+      return _path;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool HashCache::Load()
+    {
+      _entries.clear();
+      ifstream  is(_path.c_str());
+      if (! is) {
+        return (access(_path.c_str(), F_OK) != 0);
+      }
+      bool    rc = false;
+      string  line;
+      if (getline(is, line) && (line == k_magic)) {
+        rc = true;
+        while (getline(is, line)) {
+          istringstream  iss(line);
+          Key    key;
+          Entry  entry = { "", false };
+          if (iss >> key.dev >> key.ino >> key.size >> key.mtimeNs
+              >> key.ctimeNs >> entry.digest) {
+            _entries[key] = entry;
+          }
+          else {
+            rc = false;
+            _entries.clear();
+            break;
+          }
+        }
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool HashCache::Save() const
+    {
+      return CacheFile::Write(_path, [&] (ostream & os) {
+        os << k_magic << '\n';
+        for (const auto & e : _entries) {
+          if (e.second.used) {
+            os << e.first.dev << ' ' << e.first.ino << ' '
+               << e.first.size << ' ' << e.first.mtimeNs << ' '
+               << e.first.ctimeNs << ' ' << e.second.digest << '\n';
+          }
+        }
+      });
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool HashCache::Find(const struct stat & statbuf, string & digest)
+    {
+      bool  rc = false;
+      if (S_ISREG(statbuf.st_mode)) {
+        auto  it = _entries.find(Key(statbuf));
+        if (it != _entries.end()) {
+          it->second.used = true;
+          digest = it->second.digest;
+          rc = true;
+        }
+      }
+      if (rc) {
+        ++_hits;
+      }
+      else {
+        ++_misses;
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void HashCache::Add(const struct stat & statbuf, const string & digest)
+    {
+      if (S_ISREG(statbuf.st_mode) && (! digest.empty())) {
+        Key  key(statbuf);
+        if (((_startTimeNs - key.mtimeNs) > k_racyWindowNs)
+            && ((_startTimeNs - key.ctimeNs) > k_racyWindowNs)) {
+          _entries[key] = { digest, true };
+        }
+      }
+      return;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint64_t HashCache::Hits() const
+    {
+      return _hits;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint64_t HashCache::Misses() const
+    {
+      return _misses;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
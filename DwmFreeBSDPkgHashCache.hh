@@ -0,0 +1,162 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgHashCache.hh
+//!  \brief Dwm::FreeBSDPkg::HashCache class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGHASHCACHE_HH_
+#define _DWMFREEBSDPKGHASHCACHE_HH_
+
+extern "C" {
+  #include <sys/types.h>
+  #include <sys/stat.h>
+}
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  A persistent cache of file digests, keyed by file identity: device,
+    //!  inode, size, modification time and status change time.  Anything
+    //!  that rewrites a file changes at least one of those, so a hit means
+    //!  the file does not need to be read again.  The cache is a plain
+    //!  text file with one entry per line.
+    //------------------------------------------------------------------------
+    class HashCache
+    {
+    public:
+      //----------------------------------------------------------------------
+      //!  Construct for the cache file at @c path.  Does not read it; call
+      //!  Load() for that.
+      //----------------------------------------------------------------------
+      HashCache(const std::string & path);
+
+      //----------------------------------------------------------------------
+      //!  Returns the path of the cache file.
+      //----------------------------------------------------------------------
+      const std::string & Path() const;
+
+      //----------------------------------------------------------------------
+      //!  Reads the cache file.  Returns false if it could not be read or
+      //!  has the wrong format, in which case the cache is empty.  A
+      //!  missing cache file is not an error.
+      //----------------------------------------------------------------------
+      bool Load();
+
+      //----------------------------------------------------------------------
+      //!  Writes the cache file.  Only entries that were found or added
+      //!  since Load() are written, so entries for files that are gone
+      //!  do not accumulate.  The file is replaced atomically.  Returns
+      //!  true on success.
+      //----------------------------------------------------------------------
+      bool Save() const;
+
+      //----------------------------------------------------------------------
+      //!  Looks up the file with the given status.  Returns true and sets
+      //!  @c digest on a hit.  Only regular files are ever cached.
+      //----------------------------------------------------------------------
+      bool Find(const struct stat & statbuf, std::string & digest);
+
+      //----------------------------------------------------------------------
+      //!  Adds the @c digest of the file with the given status.  Files
+      //!  that are not regular, and files changed so recently that a
+      //!  further change might not alter their timestamps, are not added.
+      //----------------------------------------------------------------------
+      void Add(const struct stat & statbuf, const std::string & digest);
+
+      //----------------------------------------------------------------------
+      //!  Returns the number of successful calls to Find().
+      //----------------------------------------------------------------------
+      uint64_t Hits() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the number of unsuccessful calls to Find().
+      //----------------------------------------------------------------------
+      uint64_t Misses() const;
+      
+    private:
+      //----------------------------------------------------------------------
+      //!  
+      //----------------------------------------------------------------------
+      struct Key
+      {
+        uint64_t  dev;
+        uint64_t  ino;
+        uint64_t  size;
+        int64_t   mtimeNs;
+        int64_t   ctimeNs;
+
+        Key() = default;
+        Key(const struct stat & statbuf);
+        bool operator == (const Key & key) const;
+      };
+
+      //----------------------------------------------------------------------
+      //!  
+      //----------------------------------------------------------------------
+      struct KeyHash
+      {
+        size_t operator () (const Key & key) const;
+      };
+
+      //----------------------------------------------------------------------
+      //!  
+      //----------------------------------------------------------------------
+      struct Entry
+      {
+        std::string  digest;
+        bool         used;
+      };
+      
+      std::string                            _path;
+      std::unordered_map<Key,Entry,KeyHash>  _entries;
+      int64_t                                _startTimeNs;
+      uint64_t                               _hits;
+      uint64_t                               _misses;
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGHASHCACHE_HH_
@@ -0,0 +1,313 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgLibraryResolver.cc
+//!  \brief Dwm::FreeBSDPkg::LibraryResolver class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <elf.h>
+  #include <sys/types.h>
+  #include <sys/stat.h>
+}
+
+#include <cstdlib>
+#include <fstream>
+
+#include "DwmFreeBSDPkgLibraryResolver.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    //------------------------------------------------------------------------
+    //!  The header of an ldconfig(8) hints file, from <elf-hints.h>.
+    //------------------------------------------------------------------------
+    struct ElfHintsHeader
+    {
+      uint32_t  magic;
+      uint32_t  version;
+      uint32_t  strtab;
+      uint32_t  strsize;
+      uint32_t  dirlist;
+      uint32_t  dirlistlen;
+      uint32_t  spare[26];
+    };
+
+    static const uint32_t  k_elfHintsMagic = 0x746e6845;
+    
+    //------------------------------------------------------------------------
+    //!  Splits a colon-separated search path, dropping empty elements.
+    //------------------------------------------------------------------------
+    static vector<string> SplitPath(const string & s)
+    {
+      vector<string>  rc;
+      size_t  start = 0;
+      while (start < s.size()) {
+        size_t  end = s.find(':', start);
+        if (end == string::npos) {
+          end = s.size();
+        }
+        if (end > start) {
+          rc.push_back(s.substr(start, end - start));
+        }
+        start = end + 1;
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Returns the directory search list from the hints file at
+    //!  @c path, or an empty list if it can't be read.
+    //------------------------------------------------------------------------
+    static vector<string> ReadHints(const string & path)
+    {
+      vector<string>  rc;
+      ifstream        is(path, ios::binary);
+      ElfHintsHeader  hdr;
+      if (is.read((char *)&hdr, sizeof(hdr))
+          && (k_elfHintsMagic == hdr.magic) && (1 == hdr.version)
+          && (hdr.dirlist < hdr.strsize)
+          && (hdr.dirlistlen <= (hdr.strsize - hdr.dirlist))) {
+        string  dirList(hdr.dirlistlen, '\0');
+        if (is.seekg(hdr.strtab + hdr.dirlist)
+            && is.read(&dirList[0], dirList.size())) {
+          rc = SplitPath(dirList);
+        }
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Expands $ORIGIN and ${ORIGIN} in @c dir to the directory
+    //!  containing @c origin.
+    //------------------------------------------------------------------------
+    static string ExpandOrigin(const string & dir, const string & origin)
+    {
+      if (dir.find("$ORIGIN") == string::npos
+          && dir.find("${ORIGIN}") == string::npos) {
+        return dir;
+      }
+      size_t  slash = origin.find_last_of('/');
+      string  originDir((slash == string::npos) ? string(".")
+                        : ((slash == 0) ? string("/")
+                           : origin.substr(0, slash)));
+      string  rc(dir);
+      for (const string & var : { string("${ORIGIN}"), string("$ORIGIN") }) {
+        size_t  pos;
+        while ((pos = rc.find(var)) != string::npos) {
+          rc.replace(pos, var.size(), originDir);
+        }
+      }
+      return rc;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    LibraryResolver::LibraryResolver()
+        : _ldLibraryPath(), _defaultDirs(), _libraries(), _deps()
+    {
+      const char  *ldLibraryPath = getenv("LD_LIBRARY_PATH");
+      if (ldLibraryPath) {
+        _ldLibraryPath = SplitPath(ldLibraryPath);
+      }
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool LibraryResolver::Resolve(const ElfFile & elf, set<string> & libs)
+    {
+      const Deps      & deps = DirectDeps(elf, elf);
+      bool              rc = deps.complete;
+      vector<string>    toVisit;
+      for (const auto & lib : deps.libs) {
+        if (libs.insert(lib).second) {
+          toVisit.push_back(lib);
+        }
+      }
+      while (! toVisit.empty()) {
+        string  path = toVisit.back();
+        toVisit.pop_back();
+        const Deps  & libDeps = DirectDeps(GetLibrary(path).elf, elf);
+        rc &= libDeps.complete;
+        for (const auto & lib : libDeps.libs) {
+          if (libs.insert(lib).second) {
+            toVisit.push_back(lib);
+          }
+        }
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Returns the hints file directories followed by the standard
+    //!  directories for objects of class @c elfClass.  32-bit objects on
+    //!  a 64-bit host use the lib32 compatibility directories.
+    //------------------------------------------------------------------------
+    const LibraryResolver::PathList &
+    LibraryResolver::DefaultDirs(uint8_t elfClass)
+    {
+      auto  it = _defaultDirs.find(elfClass);
+      if (it == _defaultDirs.end()) {
+        bool  compat32 = ((ELFCLASS32 == elfClass) && (sizeof(void *) == 8));
+        PathList  dirs = ReadHints(compat32 ? "/var/run/ld-elf32.so.hints"
+                                   : "/var/run/ld-elf.so.hints");
+        if (compat32) {
+          dirs.push_back("/lib32");
+          dirs.push_back("/usr/lib32");
+        }
+        else {
+          dirs.push_back("/lib");
+          dirs.push_back("/usr/lib");
+        }
+        it = _defaultDirs.insert({elfClass, dirs}).first;
+      }
+      return it->second;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const LibraryResolver::Library &
+    LibraryResolver::GetLibrary(const string & path)
+    {
+      auto  it = _libraries.find(path);
+      if (it == _libraries.end()) {
+        Library      lib;
+        struct stat  statbuf;
+        lib.valid = ((stat(path.c_str(), &statbuf) == 0)
+                     && S_ISREG(statbuf.st_mode)
+                     && lib.elf.Read(path));
+        it = _libraries.insert({path, lib}).first;
+      }
+      return it->second;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Returns the first library named @c name in @c dirs that @c elf
+    //!  could load, or an empty string if there is none.
+    //------------------------------------------------------------------------
+    string LibraryResolver::FindIn(const PathList & dirs, const string & name,
+                                   const ElfFile & elf, const string & origin)
+    {
+      for (const auto & dir : dirs) {
+        string  path(ExpandOrigin(dir, origin) + '/' + name);
+        const Library  & lib = GetLibrary(path);
+        if (lib.valid && (lib.elf.Class() == elf.Class())
+            && (lib.elf.Machine() == elf.Machine())) {
+          return path;
+        }
+      }
+      return string();
+    }
+    
+    //------------------------------------------------------------------------
+    //!  Finds the library @c name needed by @c elf, which was loaded
+    //!  (perhaps indirectly) by @c mainElf.
+    //------------------------------------------------------------------------
+    string LibraryResolver::Find(const string & name, const ElfFile & elf,
+                                 const ElfFile & mainElf)
+    {
+      string  rc;
+      if (name.find('/') != string::npos) {
+        const Library  & lib = GetLibrary(name);
+        if (lib.valid && (lib.elf.Class() == elf.Class())
+            && (lib.elf.Machine() == elf.Machine())) {
+          rc = name;
+        }
+        return rc;
+      }
+      if (elf.RunPath().empty()) {
+        rc = FindIn(SplitPath(elf.RPath()), name, elf, elf.Path());
+        if (rc.empty() && (&elf != &mainElf) && mainElf.RunPath().empty()) {
+          rc = FindIn(SplitPath(mainElf.RPath()), name, elf, mainElf.Path());
+        }
+      }
+      if (rc.empty()) {
+        rc = FindIn(_ldLibraryPath, name, elf, elf.Path());
+      }
+      if (rc.empty()) {
+        rc = FindIn(SplitPath(elf.RunPath()), name, elf, elf.Path());
+      }
+      if (rc.empty()) {
+        rc = FindIn(DefaultDirs(elf.Class()), name, elf, elf.Path());
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Returns the libraries @c elf needs directly, and whether they
+    //!  were all found.  Since the main
+    //!  object's DT_RPATH can affect the search, its directories are part
+    //!  of the key, with $ORIGIN expanded for the main object (two
+    //!  programs with the same "$ORIGIN/../lib" in different directories
+    //!  search different places).
+    //------------------------------------------------------------------------
+    const LibraryResolver::Deps &
+    LibraryResolver::DirectDeps(const ElfFile & elf, const ElfFile & mainElf)
+    {
+      string  key(elf.Path() + '\n');
+      if (elf.RunPath().empty() && mainElf.RunPath().empty()) {
+        for (const auto & dir : SplitPath(mainElf.RPath())) {
+          key += ExpandOrigin(dir, mainElf.Path()) + ':';
+        }
+      }
+      auto  it = _deps.find(key);
+      if (it == _deps.end()) {
+        Deps  deps = { PathList(), true };
+        for (const auto & name : elf.Needed()) {
+          string  path = Find(name, elf, mainElf);
+          if (! path.empty()) {
+            deps.libs.push_back(path);
+          }
+          else {
+            deps.complete = false;
+          }
+        }
+        it = _deps.insert({key, deps}).first;
+      }
+      return it->second;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
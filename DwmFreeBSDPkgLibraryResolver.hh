@@ -0,0 +1,123 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgLibraryResolver.hh
+//!  \brief Dwm::FreeBSDPkg::LibraryResolver class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGLIBRARYRESOLVER_HH_
+#define _DWMFREEBSDPKGLIBRARYRESOLVER_HH_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "DwmFreeBSDPkgElfFile.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  Finds the shared libraries an ELF object would load, the way
+    //!  rtld(1) would: DT_RPATH (when there is no DT_RUNPATH),
+    //!  LD_LIBRARY_PATH, DT_RUNPATH, the directories in the ldconfig(8)
+    //!  hints file and then the standard directories, skipping libraries
+    //!  of the wrong class or machine.  $ORIGIN in DT_RPATH and
+    //!  DT_RUNPATH is expanded.  Like ldd(1), libraries needed by
+    //!  libraries are included.
+    //!
+    //!  Libraries are read once per resolver, so one resolver should be
+    //!  used for all of the objects in a scan.  Not safe for concurrent
+    //!  use.
+    //------------------------------------------------------------------------
+    class LibraryResolver
+    {
+    public:
+      LibraryResolver();
+
+      //----------------------------------------------------------------------
+      //!  Adds the paths of the libraries needed by @c elf, directly or
+      //!  indirectly, to @c libs.  Libraries that can't be found are
+      //!  skipped, and false is returned so callers know the result
+      //!  could change if one is installed later.
+      //----------------------------------------------------------------------
+      bool Resolve(const ElfFile & elf, std::set<std::string> & libs);
+
+    private:
+      //----------------------------------------------------------------------
+      //!  A library (or a path we tried as a library) that we have read.
+      //----------------------------------------------------------------------
+      struct Library
+      {
+        bool     valid;
+        ElfFile  elf;
+      };
+
+      typedef std::vector<std::string>  PathList;
+
+      //----------------------------------------------------------------------
+      //!  The libraries an object needs directly, and whether all of
+      //!  them were found.
+      //----------------------------------------------------------------------
+      struct Deps
+      {
+        PathList  libs;
+        bool      complete;
+      };
+      
+      PathList                         _ldLibraryPath;
+      std::map<uint8_t,PathList>       _defaultDirs;
+      std::map<std::string,Library>    _libraries;
+      std::map<std::string,Deps>       _deps;
+
+      const PathList & DefaultDirs(uint8_t elfClass);
+      const Library & GetLibrary(const std::string & path);
+      std::string FindIn(const PathList & dirs, const std::string & name,
+                         const ElfFile & elf, const std::string & origin);
+      std::string Find(const std::string & name, const ElfFile & elf,
+                       const ElfFile & mainElf);
+      const Deps & DirectDeps(const ElfFile & elf, const ElfFile & mainElf);
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGLIBRARYRESOLVER_HH_
@@ -169,6 +169,37 @@ namespace Dwm {
         std::string  _group;
         mode_t       _mode;
       };
+
+      //----------------------------------------------------------------------
+      //!  Writes the 'files:' section of a manifest to an ostream one
+      //!  entry at a time, so the caller doesn't need to hold all of the
+      //!  entries in memory.  Nothing is written if no entries are.
+      //----------------------------------------------------------------------
+      class FilesWriter
+      {
+      public:
+        FilesWriter(std::ostream & os);
+
+        //--------------------------------------------------------------------
+        //!  Calls Close().
+        //--------------------------------------------------------------------
+        ~FilesWriter();
+
+        //--------------------------------------------------------------------
+        //!  Writes one entry.
+        //--------------------------------------------------------------------
+        void Write(const File & file);
+
+        //--------------------------------------------------------------------
+        //!  Finishes the section.  Later calls do nothing.
+        //--------------------------------------------------------------------
+        void Close();
+
+      private:
+        std::ostream  & _os;
+        size_t          _count;
+        bool            _closed;
+      };
       
       //----------------------------------------------------------------------
       //!  Returns the package name from the manifest.
@@ -450,7 +481,8 @@ namespace Dwm {
       
       //----------------------------------------------------------------------
       //!  Parses the manifest from the given @c filename.  Returns true
-      //!  on success, false on failure.
+      //!  on success, false on failure.  The parser keeps no global
+      //!  state, so different Manifest objects may be parsed concurrently.
       //----------------------------------------------------------------------
       bool Parse(const char *filename);
 
@@ -460,6 +492,18 @@ namespace Dwm {
       //----------------------------------------------------------------------
       std::vector<File> MissingFiles(const std::string & dirName) const;
 
+      //----------------------------------------------------------------------
+      //!  Prints everything in the manifest that precedes the 'files:'
+      //!  section.  Used with FilesWriter and PrintScripts() to emit a
+      //!  manifest whose files are not all in memory at once.
+      //----------------------------------------------------------------------
+      std::ostream & PrintHead(std::ostream & os) const;
+
+      //----------------------------------------------------------------------
+      //!  Prints the 'scripts:' section of the manifest, if any.
+      //----------------------------------------------------------------------
+      std::ostream & PrintScripts(std::ostream & os) const;
+      
       friend std::ostream & operator << (std::ostream & os,
                                          const Manifest & manifest);
       
@@ -476,7 +520,7 @@ namespace Dwm {
       std::string               _licenseLogic;
       std::vector<std::string>  _categories;
       std::vector<std::string>  _licenses;
-      size_t                    _flatsize;
+      size_t                    _flatsize = 0;
       std::vector<Dependency>   _dependencies;
       std::string               _conflict;
       std::vector<Option>       _options;
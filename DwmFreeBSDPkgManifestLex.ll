@@ -43,18 +43,6 @@
 extern "C" {
   #include <stdarg.h>
   #include <stdio.h>
-  
-  //--------------------------------------------------------------------------
-  //!  
-  //--------------------------------------------------------------------------
-  void pkgmnfsterror(const char *arg, ...)
-  {
-    va_list  ap;
-    va_start(ap, arg);
-    vfprintf(stderr, arg, ap);
-    fprintf(stderr, ": %s at line %d\n", yytext, yylineno);
-    return;
-  }
 }
   
 #include <map>
@@ -68,6 +56,8 @@ using namespace std;
 #include "DwmFreeBSDPkgManifest.hh"
 #include "DwmFreeBSDPkgManifestParse.hh"
 
+#define YYSTYPE PKGMNFSTSTYPE
+
 //----------------------------------------------------------------------------
 //!  
 //----------------------------------------------------------------------------
@@ -100,6 +90,7 @@ int GetStringToken(const char *str)
     { "deps",           DEPS },
     { "desc",           DESC },
     { "files",          FILES },
+    { "flatsize",       FLATSIZE },
     { "gname",          GNAME },
     { "licenselogic",   LICENSELOGIC },
     { "licenses",       LICENSES },
@@ -109,6 +100,7 @@ int GetStringToken(const char *str)
     { "perm",           PERM },
     { "prefix",         PREFIX },
     { "scripts",        SCRIPTS },
+    { "sum",            SUM },
     { "install",        INSTALL },
     { "post-install",   POSTINSTALL },
     { "pre-install",    PREINSTALL },
@@ -149,7 +141,7 @@ std::string GetScriptName(const std::string & scriptNameMatch)
   
 %}
 
-%option noyywrap yylineno
+%option noyywrap yylineno reentrant bison-bridge
 %option outfile="DwmFreeBSDPkgManifestLex.cc"
 %option prefix="pkgmnfst"
 
@@ -170,15 +162,30 @@ m_scriptName   ^[ \t]{2}(((post-|post-de|pre-|pre-de|de)*install)|((pre-|post-)*
 <INITIAL>\"                     { BEGIN(x_quotedString); return '"'; }
 <x_quotedString>([^"]|[\\"]["])+  { int tok = GetStringToken(yytext);
                                   if ((tok == STRING) || IsScriptName(tok)) {
-                                    pkgmnfstlval.stringVal = 
+                                    yylval->stringVal = 
                                       new std::string(yytext);
                                   }
                                   return tok; }
 <x_quotedString>\"              { BEGIN(INITIAL); return '"'; }
-<INITIAL>[^:,{}\[\]" \t\n]+     { pkgmnfstlval.stringVal =
+<INITIAL>[^:,{}\[\]" \t\n]+     { yylval->stringVal =
                                     new std::string(yytext);
                                   return GetStringToken(yytext); }
 <INITIAL>^[ \t]*\#.*\n
 [ \t\n]+
 
 %%
+
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+void pkgmnfsterror(yyscan_t scanner, Dwm::FreeBSDPkg::Manifest *manifest,
+                   const char *arg, ...)
+{
+  va_list  ap;
+  va_start(ap, arg);
+  vfprintf(stderr, arg, ap);
+  va_end(ap);
+  fprintf(stderr, ": %s at line %d\n", pkgmnfstget_text(scanner),
+          pkgmnfstget_lineno(scanner));
+  return;
+}
@@ -41,15 +41,10 @@
 //!  \ Dwm::FreeBSDPkg::Manifest implementation and parser
 //---------------------------------------------------------------------------
 
-extern int pkgmnfstlex();
-
 extern "C" {
   #include <stdio.h>
   #include <sys/types.h>
   #include <sys/stat.h>
-  
-  extern void pkgmnfsterror(const char *arg, ...);
-  extern FILE *pkgmnfstin;
 }
 
 #include <map>
@@ -60,13 +55,34 @@ extern "C" {
 
 #include "DwmFreeBSDPkgManifest.hh"
 
-static Dwm::FreeBSDPkg::Manifest *g_manifest = 0;
-
 using namespace std;
 
 %}
 
+%code requires {
+  //  The parser and lexer are reentrant; all of the state of one parse
+  //  is in the scanner and the manifest being filled in, so manifests
+  //  may be parsed concurrently from different threads.
+  #ifndef YY_TYPEDEF_YY_SCANNER_T
+  #define YY_TYPEDEF_YY_SCANNER_T
+  typedef void *yyscan_t;
+  #endif
+}
+
+%code {
+  extern int pkgmnfstlex(PKGMNFSTSTYPE *lvalp, yyscan_t scanner);
+  extern int pkgmnfstlex_init(yyscan_t *scanner);
+  extern void pkgmnfstset_in(FILE *in, yyscan_t scanner);
+  extern int pkgmnfstlex_destroy(yyscan_t scanner);
+  extern void pkgmnfsterror(yyscan_t scanner,
+                            Dwm::FreeBSDPkg::Manifest *manifest,
+                            const char *arg, ...);
+}
+
 %define api.prefix {pkgmnfst}
+%define api.pure full
+%lex-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {Dwm::FreeBSDPkg::Manifest *manifest}
 
 %union {
   const string                                        *stringVal;
@@ -79,19 +95,22 @@ using namespace std;
   std::vector<std::string>                            *stringVecVal;
 }
 
-%token ARCH CATEGORIES COMMENT DESC DEPS FILES GNAME LICENSELOGIC LICENSES
-%token MAINTAINER NAME ORIGIN PERM PIPEHYPHEN PREFIX SCRIPTS UNAME VERSION WWW
+%token ARCH CATEGORIES COMMENT DESC DEPS FILES FLATSIZE GNAME LICENSELOGIC
+%token LICENSES MAINTAINER NAME ORIGIN PERM PIPEHYPHEN PREFIX SCRIPTS SUM UNAME
+%token VERSION WWW
 %token <stringVal> DEINSTALL INSTALL POSTDEINSTALL POSTINSTALL POSTUPGRADE
 %token <stringVal> PREDEINSTALL PREINSTALL PREUPGRADE SCRIPTNAME SCRIPTLINE
 %token <stringVal> STRING UPGRADE
 
-%type <stringVal> Arch Comment Desc LicenseLogic Maintainer Name Origin Prefix
+%type <stringVal> Arch Comment Desc Flatsize LicenseLogic Maintainer Name Origin
+%type <stringVal> Prefix
 %type <stringVal> QuotedString ScriptName StringValue Version Www
 %type <depVal> Dependency
 %type <depVecVal> DependencyList Dependencies
 %type <fileVal> File
 %type <fileVecVal> FileList Files
-%type <stringPairVal> FileAttribute FileGroup FileOwner FilePermissions Script
+%type <stringPairVal> FileAttribute FileGroup FileOwner FilePermissions FileSum
+%type <stringPairVal> Script
 %type <stringMapVal> FileAttributes ScriptMap Scripts
 %type <stringVecVal> Categories CategoryList Licenses LicenseList
 
@@ -101,59 +120,63 @@ Contents: Content { }
 | Contents Content { };
 
 Content: Dependencies {
-  g_manifest->Dependencies(*$1);
+  manifest->Dependencies(*$1);
   delete $1;
 }
 | Files {
-  g_manifest->Files(*$1);
+  manifest->Files(*$1);
   delete $1;
 }
 | Desc {
-  g_manifest->Description(*$1);
+  manifest->Description(*$1);
   delete $1;
 }
 | Prefix {
-  g_manifest->Prefix(*$1);
+  manifest->Prefix(*$1);
   delete $1;
 }
 | Arch {
-  g_manifest->Arch(*$1);
+  manifest->Arch(*$1);
   delete $1;
 }
 | Www {
-  g_manifest->WWW(*$1);
+  manifest->WWW(*$1);
   delete $1;
 }
 | Categories {
-  g_manifest->Categories(*$1);
+  manifest->Categories(*$1);
   delete $1;
 }
 | LicenseLogic {
-  g_manifest->LicenseLogic(*$1);
+  manifest->LicenseLogic(*$1);
   delete $1;
 }
 | Licenses {
-  g_manifest->Licenses(*$1);
+  manifest->Licenses(*$1);
   delete $1;
 }
 | Maintainer {
-  g_manifest->Maintainer(*$1);
+  manifest->Maintainer(*$1);
   delete $1;
 }
 | Comment {
-  g_manifest->Comment(*$1);
+  manifest->Comment(*$1);
   delete $1;
 }
 | Origin {
-  g_manifest->Origin(*$1);
+  manifest->Origin(*$1);
   delete $1;
 }
 | Name {
-  g_manifest->Name(*$1);
+  manifest->Name(*$1);
   delete $1;
 }
 | Version {
-  g_manifest->Version(*$1);
+  manifest->Version(*$1);
+  delete $1;
+}
+| Flatsize {
+  manifest->Flatsize(strtoull($1->c_str(), 0, 10));
   delete $1;
 }
 | Scripts {
@@ -172,7 +195,7 @@ Content: Dependencies {
   for (auto s : *$1) {
     auto it = scriptSetters.find(s.first);
     if (it != scriptSetters.end()) {
-      (g_manifest->*(it->second))(s.second);
+      (manifest->*(it->second))(s.second);
     }
   }
   delete $1;
@@ -300,6 +323,10 @@ File: StringValue ':' '{' FileAttributes '}' {
   if (it != $4->end()) {
     $$->Mode(strtoul(it->second.c_str(), 0, 8));
   }
+  it = $4->find("sum");
+  if (it != $4->end()) {
+    $$->SHA256(it->second);
+  }
   delete $1;
   delete $4;
 }
@@ -326,7 +353,8 @@ FileAttributes: FileAttribute {
 
 FileAttribute: FilePermissions { $$ = $1; }
 | FileGroup { $$ = $1; }
-| FileOwner { $$ = $1; };
+| FileOwner { $$ = $1; }
+| FileSum { $$ = $1; };
 
 FilePermissions: PERM ':' StringValue {
   $$ = new std::pair<std::string,std::string>("perm", *$3);
@@ -343,6 +371,11 @@ FileOwner: UNAME ':' StringValue {
   delete $3;
 };
 
+FileSum: SUM ':' StringValue {
+  $$ = new std::pair<std::string,std::string>("sum", *$3);
+  delete $3;
+};
+
 Desc: DescKey ':' StringValue { $$ = $3; };
 DescKey: '"' DESC '"' | DESC;
 
@@ -370,6 +403,9 @@ NameKey: '"' NAME '"' | NAME;
 Version: VersionKey ':' StringValue { $$ = $3; };
 VersionKey: '"' VERSION '"' | VERSION;
 
+Flatsize: FlatsizeKey ':' StringValue { $$ = $3; };
+FlatsizeKey: '"' FLATSIZE '"' | FLATSIZE;
+
 StringValue: QuotedString { $$ = $1; }
 | STRING { $$ = $1; };
 
@@ -578,47 +614,56 @@ namespace Dwm {
     {
       if (os) {
         os << '"' << file._path;
-#if 0
-        if (! file._sha256.empty()) {
-          os << "\":\"" << file._sha256 << "\"";
+        bool  needComma = false, openBracePrinted = false;
+        if (! file.User().empty()) {
+          os << "\":{uname: " << file.User();
+          openBracePrinted = true;
+          needComma = true;
         }
-        else {
-#endif
-          bool  needComma = false, openBracePrinted = false;
-          if (! file.User().empty()) {
-            os << "\":{uname: " << file.User();
+        if (! file.Group().empty()) {
+          if (! openBracePrinted) {
+            os << "\":{"; openBracePrinted = true;
+          }
+          if (needComma) {
+            os << ", ";
+          }
+          os << "gname: " << file.Group();
+          needComma = true;
+        }
+        if (file.Mode()) {
+          if (! openBracePrinted) {
+            os << "\":{";
             openBracePrinted = true;
-            needComma = true;
           }
-          if (! file.Group().empty()) {
-            if (! openBracePrinted) {
-              os << "\":{"; openBracePrinted = true;
-            }
-            if (needComma) {
-              os << ", ";
-            }
-            os << "gname: " << file.Group();
-            needComma = true;
+          if (needComma) {
+            os << ", ";
           }
-          if (file.Mode()) {
-            if (! openBracePrinted) {
-              os << "\":{";
-              openBracePrinted = true;
-            }
+          os << "perm: " << oct <<showbase << file.Mode() << dec;
+          needComma = true;
+        }
+        if (! file._sha256.empty()) {
+          //  pkg checksums are '<type>$<digest>', where type 1 is a
+          //  hex SHA-256.  Add the type if we only have the digest.
+          string  sum(file._sha256);
+          if (sum.find('$') == string::npos) {
+            sum = "1$" + sum;
+          }
+          if (openBracePrinted) {
             if (needComma) {
               os << ", ";
             }
-            os << "perm: " << oct <<showbase << file.Mode() << dec;
-          }
-          if (openBracePrinted) {
-            os << '}';
+            os << "sum: \"" << sum << "\"";
           }
           else {
-            os << '"';
+            os << "\":\"" << sum << '"';
           }
-#if 0
         }
-#endif
+        if (openBracePrinted) {
+          os << '}';
+        }
+        else if (file._sha256.empty()) {
+          os << '"';
+        }
       }
       return os;
     }
@@ -1092,12 +1137,16 @@ namespace Dwm {
     bool Manifest::Parse(const char *filename)
     {
       bool  rc = false;
-      g_manifest = this;
-      pkgmnfstin = fopen(filename, "r");
-      if (pkgmnfstin) {
-        pkgmnfstparse();
-        rc = true;
-        fclose(pkgmnfstin);
+      FILE  *f = fopen(filename, "r");
+      if (f) {
+        yyscan_t  scanner;
+        if (pkgmnfstlex_init(&scanner) == 0) {
+          pkgmnfstset_in(f, scanner);
+          pkgmnfstparse(scanner, this);
+          pkgmnfstlex_destroy(scanner);
+          rc = true;
+        }
+        fclose(f);
       }
       return rc;
     }
@@ -1168,7 +1217,46 @@ namespace Dwm {
     //------------------------------------------------------------------------
     //!  
     //------------------------------------------------------------------------
-    ostream & operator << (ostream & os, const Manifest & manifest)
+    Manifest::FilesWriter::FilesWriter(ostream & os)
+        : _os(os), _count(0), _closed(false)
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    Manifest::FilesWriter::~FilesWriter()
+    {
+      Close();
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void Manifest::FilesWriter::Write(const File & file)
+    {
+      if (_os) {
+        _os << (_count ? ",\n  " : "files: {\n  ") << file;
+        ++_count;
+      }
+      return;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void Manifest::FilesWriter::Close()
+    {
+      if ((! _closed) && _count && _os) {
+        _os << "\n}\n";
+      }
+      _closed = true;
+      return;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    ostream & Manifest::PrintHead(ostream & os) const
     {
       typedef const string & (Manifest::*StringFieldGetFn)() const;
       static const vector<pair<string,StringFieldGetFn> >  fieldGetters = {
@@ -1184,39 +1272,49 @@ namespace Dwm {
       };
       if (os) {
         for (auto fgit : fieldGetters) {
-          if (! (manifest.*(fgit.second))().empty()) {
+          if (! (this->*(fgit.second))().empty()) {
             os << fgit.first << ": "
-               << "\"" << (manifest.*(fgit.second))() << "\"\n";
+               << "\"" << (this->*(fgit.second))() << "\"\n";
           }
         }
-        if (! manifest._licenses.empty()) {
-          os << "licenses: [" << manifest._licenses << "]\n";
+        if (! _licenses.empty()) {
+          os << "licenses: [" << _licenses << "]\n";
         }
-        if (! manifest._categories.empty()) {
-          os << "categories: [" << manifest._categories << "]\n";
+        if (! _categories.empty()) {
+          os << "categories: [" << _categories << "]\n";
         }
-        if (! manifest._dependencies.empty()) {
-          os << "deps: " << manifest._dependencies;
+        if (_flatsize) {
+          os << "flatsize: " << _flatsize << '\n';
         }
-        if (! manifest._files.empty()) {
-          os << "files: " << manifest._files;
+        if (! _dependencies.empty()) {
+          os << "deps: " << _dependencies;
         }
-        typedef const string & (Manifest::*ScriptGetFn)() const;
-        static const vector<pair<string,ScriptGetFn> >  scriptGetters = {
-          { "post-install",    &Manifest::PostInstall },
-          { "pre-install",     &Manifest::PreInstall },
-          { "install",         &Manifest::PreInstall },
-          { "pre-deinstall",   &Manifest::PreDeinstall },
-          { "post-deinstall",  &Manifest::PostDeinstall },
-          { "deinstall",       &Manifest::Deinstall },
-          { "pre-upgrade",     &Manifest::PreUpgrade },
-          { "post-upgrade",    &Manifest::PostUpgrade },
-          { "upgrade",         &Manifest::Upgrade }
-        };
+      }
+      return os;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    ostream & Manifest::PrintScripts(ostream & os) const
+    {
+      typedef const string & (Manifest::*ScriptGetFn)() const;
+      static const vector<pair<string,ScriptGetFn> >  scriptGetters = {
+        { "post-install",    &Manifest::PostInstall },
+        { "pre-install",     &Manifest::PreInstall },
+        { "install",         &Manifest::PreInstall },
+        { "pre-deinstall",   &Manifest::PreDeinstall },
+        { "post-deinstall",  &Manifest::PostDeinstall },
+        { "deinstall",       &Manifest::Deinstall },
+        { "pre-upgrade",     &Manifest::PreUpgrade },
+        { "post-upgrade",    &Manifest::PostUpgrade },
+        { "upgrade",         &Manifest::Upgrade }
+      };
+      if (os) {
         bool  scriptsPrinted = false;
         bool  needComma = false;
         for (auto sgit : scriptGetters) {
-          if (! (manifest.*(sgit.second))().empty()) {
+          if (! (this->*(sgit.second))().empty()) {
             if (! scriptsPrinted) {
               os << "scripts: {";
               scriptsPrinted = true;
@@ -1225,7 +1323,7 @@ namespace Dwm {
               os << ',';
             }
             os << "\n  " << sgit.first << ": \""
-               << EscapeNewlines((manifest.*(sgit.second))()) << "\"";
+               << EscapeNewlines((this->*(sgit.second))()) << "\"";
             needComma = true;
           }
         }
@@ -1236,6 +1334,21 @@ namespace Dwm {
       return os;
     }
     
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    ostream & operator << (ostream & os, const Manifest & manifest)
+    {
+      if (os) {
+        manifest.PrintHead(os);
+        if (! manifest._files.empty()) {
+          os << "files: " << manifest._files;
+        }
+        manifest.PrintScripts(os);
+      }
+      return os;
+    }
+    
     
   }  // namespace FreeBSDPkg
 
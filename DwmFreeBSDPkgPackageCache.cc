@@ -0,0 +1,245 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgPackageCache.cc
+//!  \brief Dwm::FreeBSDPkg::PackageCache class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <unistd.h>
+}
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "DwmFreeBSDPkgCacheFile.hh"
+#include "DwmFreeBSDPkgPackageCache.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    static const string  k_magic("mkfbsdmnfst-pkgcache 1");
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    PackageCache::DBIdentity::DBIdentity(const struct stat & statbuf)
+        : dev(statbuf.st_dev), ino(statbuf.st_ino), size(statbuf.st_size),
+          mtimeNs(((int64_t)statbuf.st_mtim.tv_sec * 1000000000LL)
+                  + statbuf.st_mtim.tv_nsec)
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PackageCache::DBIdentity::operator == (const DBIdentity & id) const
+    {
+      return ((dev == id.dev) && (ino == id.ino) && (size == id.size)
+              && (mtimeNs == id.mtimeNs));
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    PackageCache::PackageCache(const string & path)
+        : _path(path), _dbIdentity(), _owners(), _versions(), _dirty(false),
+          _hits(0), _misses(0)
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & PackageCache::Path() const
+    {
+      return _path;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PackageCache::Load(const struct stat & dbStat)
+    {
+      _owners.clear();
+      _versions.clear();
+      _dbIdentity = DBIdentity(dbStat);
+      _dirty = false;
+      ifstream  is(_path.c_str());
+      if (! is) {
+        return (access(_path.c_str(), F_OK) != 0);
+      }
+      bool        rc = false;
+      string      line;
+      DBIdentity  fileId;
+      string      tag;
+      if (getline(is, line) && (line == k_magic) && getline(is, line)
+          && (istringstream(line) >> tag >> fileId.dev >> fileId.ino
+              >> fileId.size >> fileId.mtimeNs)
+          && (tag == "db")) {
+        rc = true;
+        if (! (fileId == _dbIdentity)) {
+          //  The database changed since the cache was saved.
+          return rc;
+        }
+        while (getline(is, line)) {
+          vector<string>  fields = CacheFile::SplitFields(line);
+          if ((fields.size() == 5) && (fields[0] == "f")) {
+            _owners[fields[1]] =
+              Manifest::Dependency(fields[2], fields[3], fields[4]);
+          }
+          else if ((fields.size() == 3) && (fields[0] == "v")) {
+            _versions[fields[1]] = fields[2];
+          }
+          else {
+            rc = false;
+            _owners.clear();
+            _versions.clear();
+            break;
+          }
+        }
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PackageCache::Save()
+    {
+      if (! _dirty) {
+        return true;
+      }
+      bool  rc = CacheFile::Write(_path, [&] (ostream & os) {
+        os << k_magic << '\n'
+           << "db " << _dbIdentity.dev << ' ' << _dbIdentity.ino << ' '
+           << _dbIdentity.size << ' ' << _dbIdentity.mtimeNs << '\n';
+        for (const auto & owner : _owners) {
+          os << "f\t" << owner.first << '\t' << owner.second.Name() << '\t'
+             << owner.second.Origin() << '\t' << owner.second.Version()
+             << '\n';
+        }
+        for (const auto & version : _versions) {
+          os << "v\t" << version.first << '\t' << version.second << '\n';
+        }
+      });
+      if (rc) {
+        _dirty = false;
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PackageCache::FindOwner(const string & path,
+                                 Manifest::Dependency & owner)
+    {
+      auto  it = _owners.find(path);
+      if (it != _owners.end()) {
+        owner = it->second;
+        ++_hits;
+        return true;
+      }
+      ++_misses;
+      return false;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void PackageCache::AddOwner(const string & path,
+                                const Manifest::Dependency & owner)
+    {
+      if (CacheFile::Cacheable(path) && CacheFile::Cacheable(owner.Name())
+          && CacheFile::Cacheable(owner.Origin())
+          && CacheFile::Cacheable(owner.Version())) {
+        _owners[path] = owner;
+        _dirty = true;
+      }
+      return;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PackageCache::FindVersion(const string & name, string & version)
+    {
+      auto  it = _versions.find(name);
+      if (it != _versions.end()) {
+        version = it->second;
+        ++_hits;
+        return true;
+      }
+      ++_misses;
+      return false;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void PackageCache::AddVersion(const string & name, const string & version)
+    {
+      if (CacheFile::Cacheable(name) && CacheFile::Cacheable(version)) {
+        _versions[name] = version;
+        _dirty = true;
+      }
+      return;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint64_t PackageCache::Hits() const
+    {
+      return _hits;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    uint64_t PackageCache::Misses() const
+    {
+      return _misses;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
@@ -0,0 +1,165 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgPackageCache.hh
+//!  \brief Dwm::FreeBSDPkg::PackageCache class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGPACKAGECACHE_HH_
+#define _DWMFREEBSDPKGPACKAGECACHE_HH_
+
+extern "C" {
+  #include <sys/types.h>
+  #include <sys/stat.h>
+}
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "DwmFreeBSDPkgManifest.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  A persistent cache of answers from the pkg database: the package
+    //!  that owns a file (or that no package does) and the installed
+    //!  version of a package (or that it isn't installed).  The answers
+    //!  only hold for one state of the database, so the cache records the
+    //!  identity of the database file (device, inode, size and
+    //!  modification time) and is discarded when that changes.  The
+    //!  cache is a plain text file with one entry per line.
+    //------------------------------------------------------------------------
+    class PackageCache
+    {
+    public:
+      //----------------------------------------------------------------------
+      //!  Construct for the cache file at @c path.  Does not read it; call
+      //!  Load() for that.
+      //----------------------------------------------------------------------
+      PackageCache(const std::string & path);
+
+      //----------------------------------------------------------------------
+      //!  Returns the path of the cache file.
+      //----------------------------------------------------------------------
+      const std::string & Path() const;
+
+      //----------------------------------------------------------------------
+      //!  Reads the cache file, keeping its entries only if they were
+      //!  saved for the database file with status @c dbStat.  Returns
+      //!  false if the cache file could not be read or has the wrong
+      //!  format, in which case the cache is empty.  A missing or stale
+      //!  cache file is not an error.
+      //----------------------------------------------------------------------
+      bool Load(const struct stat & dbStat);
+
+      //----------------------------------------------------------------------
+      //!  Writes the cache file if anything was added since Load().  The
+      //!  file is replaced atomically.  Returns true on success.
+      //----------------------------------------------------------------------
+      bool Save();
+
+      //----------------------------------------------------------------------
+      //!  Looks up the owner of the file at @c path.  Returns true on a
+      //!  hit and sets @c owner, whose name is empty if no package owns
+      //!  the file.
+      //----------------------------------------------------------------------
+      bool FindOwner(const std::string & path, Manifest::Dependency & owner);
+
+      //----------------------------------------------------------------------
+      //!  Adds the @c owner of the file at @c path.  Pass an owner with
+      //!  an empty name if no package owns the file.
+      //----------------------------------------------------------------------
+      void AddOwner(const std::string & path,
+                    const Manifest::Dependency & owner);
+
+      //----------------------------------------------------------------------
+      //!  Looks up the installed version of the package named @c name.
+      //!  Returns true on a hit and sets @c version, which is empty if the
+      //!  package isn't installed.
+      //----------------------------------------------------------------------
+      bool FindVersion(const std::string & name, std::string & version);
+
+      //----------------------------------------------------------------------
+      //!  Adds the installed @c version of the package named @c name.
+      //!  Pass an empty version if the package isn't installed.
+      //----------------------------------------------------------------------
+      void AddVersion(const std::string & name, const std::string & version);
+      
+      //----------------------------------------------------------------------
+      //!  Returns the number of successful lookups.
+      //----------------------------------------------------------------------
+      uint64_t Hits() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the number of unsuccessful lookups.
+      //----------------------------------------------------------------------
+      uint64_t Misses() const;
+      
+    private:
+      //----------------------------------------------------------------------
+      //!  
+      //----------------------------------------------------------------------
+      struct DBIdentity
+      {
+        uint64_t  dev;
+        uint64_t  ino;
+        uint64_t  size;
+        int64_t   mtimeNs;
+
+        DBIdentity() = default;
+        DBIdentity(const struct stat & statbuf);
+        bool operator == (const DBIdentity & id) const;
+      };
+
+      std::string                                           _path;
+      DBIdentity                                            _dbIdentity;
+      std::unordered_map<std::string,Manifest::Dependency>  _owners;
+      std::unordered_map<std::string,std::string>           _versions;
+      bool                                                  _dirty;
+      uint64_t                                              _hits;
+      uint64_t                                              _misses;
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGPACKAGECACHE_HH_
@@ -0,0 +1,364 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgPackageDB.cc
+//!  \brief Dwm::FreeBSDPkg::PackageDB class implementation
+//---------------------------------------------------------------------------
+
+#include <algorithm>
+#include <iostream>
+
+#include "DwmFreeBSDPkgPackageDB.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    PackageDB::PackageDB()
+        : _path(), _db(nullptr), _cache(nullptr), _insertNameStmt(nullptr),
+          _versionsForNamesStmt(nullptr), _insertPathStmt(nullptr),
+          _packagesForPathsStmt(nullptr)
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    PackageDB::~PackageDB()
+    {
+      Close();
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PackageDB::Open(const string & path)
+    {
+      Close();
+      _path = path;
+      string  uri("file:" + path + "?immutable=1");
+      if (sqlite3_open_v2(uri.c_str(), &_db,
+                          SQLITE_OPEN_READONLY|SQLITE_OPEN_URI, 0)
+          != SQLITE_OK) {
+        cerr << "sqlite3_open_v2(\"" << path << "\") failed {"
+             << __FILE__ << ':' << __LINE__ << "}\n";
+        Close();
+        return false;
+      }
+      return true;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void PackageDB::Close()
+    {
+      for (sqlite3_stmt **stmt : { &_insertNameStmt, &_versionsForNamesStmt,
+                                   &_insertPathStmt,
+                                   &_packagesForPathsStmt }) {
+        if (*stmt) {
+          sqlite3_finalize(*stmt);
+          *stmt = nullptr;
+        }
+      }
+      if (_db) {
+        sqlite3_close_v2(_db);
+        _db = nullptr;
+      }
+      return;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PackageDB::IsOpen() const
+    {
+      return (nullptr != _db);
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & PackageDB::Path() const
+    {
+      return _path;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    PackageCache *PackageDB::Cache() const
+    {
+      return _cache;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    PackageCache *PackageDB::Cache(PackageCache *cache)
+    {
+      _cache = cache;
+      return _cache;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    map<string,string> PackageDB::InstalledVersions(const set<string> & names)
+    {
+      static const char  *selectSql =
+        "select packages.name, packages.version from temp.wanted_names"
+        " join packages on packages.name = wanted_names.name";
+      
+      map<string,string>  rc;
+      set<string>         misses;
+      for (const auto & name : names) {
+        string  version;
+        if (_cache && _cache->FindVersion(name, version)) {
+          if (! version.empty()) {
+            rc[name] = version;
+          }
+        }
+        else {
+          misses.insert(name);
+        }
+      }
+      if ((! _db) || misses.empty()) {
+        return rc;
+      }
+      if (! FillTempTable("wanted_names", "name", _insertNameStmt, misses)) {
+        return rc;
+      }
+      if (! _versionsForNamesStmt) {
+        if (! (_versionsForNamesStmt = Prepare(selectSql))) {
+          return rc;
+        }
+      }
+      map<string,string>  found;
+      while (sqlite3_step(_versionsForNamesStmt) == SQLITE_ROW) {
+        found.emplace((const char *)
+                      sqlite3_column_text(_versionsForNamesStmt, 0),
+                      (const char *)
+                      sqlite3_column_text(_versionsForNamesStmt, 1));
+      }
+      sqlite3_reset(_versionsForNamesStmt);
+      for (const auto & name : misses) {
+        auto    it = found.find(name);
+        string  version((it != found.end()) ? it->second : string());
+        if (_cache) {
+          _cache->AddVersion(name, version);
+        }
+        if (! version.empty()) {
+          rc[name] = version;
+        }
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    vector<Manifest::Dependency>
+    PackageDB::PackagesForFiles(const set<string> & paths)
+    {
+      static const char  *selectSql =
+        "select needed_files.path, packages.name, packages.origin,"
+        " packages.version from temp.needed_files"
+        " join files on files.path = needed_files.path"
+        " join packages on packages.id = files.package_id";
+      
+      vector<Manifest::Dependency>  owners;
+      set<string>                   misses;
+      for (const auto & path : paths) {
+        Manifest::Dependency  owner;
+        if (_cache && _cache->FindOwner(path, owner)) {
+          if (! owner.Name().empty()) {
+            owners.push_back(owner);
+          }
+        }
+        else {
+          misses.insert(path);
+        }
+      }
+      if (_db && (! misses.empty())
+          && FillTempTable("needed_files", "path", _insertPathStmt, misses)
+          && (_packagesForPathsStmt
+              || (_packagesForPathsStmt = Prepare(selectSql)))) {
+        while (sqlite3_step(_packagesForPathsStmt) == SQLITE_ROW) {
+          string  path((const char *)
+                       sqlite3_column_text(_packagesForPathsStmt, 0));
+          Manifest::Dependency  owner(
+            (const char *)sqlite3_column_text(_packagesForPathsStmt, 1),
+            (const char *)sqlite3_column_text(_packagesForPathsStmt, 2),
+            (const char *)sqlite3_column_text(_packagesForPathsStmt, 3));
+          if (_cache) {
+            _cache->AddOwner(path, owner);
+          }
+          misses.erase(path);
+          owners.push_back(owner);
+        }
+        sqlite3_reset(_packagesForPathsStmt);
+        //  What's left isn't owned by any package.
+        if (_cache) {
+          for (const auto & path : misses) {
+            _cache->AddOwner(path, Manifest::Dependency());
+          }
+        }
+      }
+      //  One entry per package name, preferring the lowest version.
+      sort(owners.begin(), owners.end(),
+           [] (const Manifest::Dependency & a, const Manifest::Dependency & b)
+           {
+             return ((a.Name() < b.Name())
+                     || ((a.Name() == b.Name())
+                         && (a.Version() < b.Version())));
+           });
+      vector<Manifest::Dependency>  rc;
+      for (auto & owner : owners) {
+        if (rc.empty() || (rc.back().Name() != owner.Name())) {
+          rc.push_back(std::move(owner));
+        }
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    unordered_map<string,vector<string>> PackageDB::DependencyGraph()
+    {
+      static const char  *selectSql =
+        "select packages.name, deps.name from deps"
+        " join packages on packages.id = deps.package_id";
+      
+      unordered_map<string,vector<string>>  rc;
+      if (! _db) {
+        return rc;
+      }
+      sqlite3_stmt  *stmt = Prepare(selectSql);
+      if (stmt) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+          rc[(const char *)sqlite3_column_text(stmt, 0)].push_back(
+            (const char *)sqlite3_column_text(stmt, 1));
+        }
+        sqlite3_finalize(stmt);
+      }
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PackageDB::FillTempTable(const string & table, const string & column,
+                                  sqlite3_stmt * & insertStmt,
+                                  const set<string> & values)
+    {
+      if (! insertStmt) {
+        string  createSql("create temp table if not exists " + table
+                          + " (" + column + " text primary key)"
+                          " without rowid");
+        if (! Exec(createSql.c_str())) {
+          return false;
+        }
+        string  insertSql("insert or ignore into temp." + table
+                          + " (" + column + ") values (?1)");
+        if (! (insertStmt = Prepare(insertSql.c_str()))) {
+          return false;
+        }
+      }
+      string  deleteSql("delete from temp." + table);
+      if (! (Exec(deleteSql.c_str()) && Exec("begin"))) {
+        return false;
+      }
+      bool  rc = true;
+      for (const auto & value : values) {
+        sqlite3_bind_text(insertStmt, 1, value.c_str(), value.size(),
+                          SQLITE_STATIC);
+        if (sqlite3_step(insertStmt) != SQLITE_DONE) {
+          ReportError("sqlite3_step", sqlite3_sql(insertStmt));
+          rc = false;
+        }
+        sqlite3_reset(insertStmt);
+      }
+      sqlite3_clear_bindings(insertStmt);
+      return (Exec("commit") && rc);
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    sqlite3_stmt *PackageDB::Prepare(const char *sql)
+    {
+      sqlite3_stmt  *stmt = nullptr;
+      if (sqlite3_prepare_v2(_db, sql, -1, &stmt, 0) != SQLITE_OK) {
+        ReportError("sqlite3_prepare_v2", sql);
+        sqlite3_finalize(stmt);
+        stmt = nullptr;
+      }
+      return stmt;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PackageDB::Exec(const char *sql)
+    {
+      if (sqlite3_exec(_db, sql, nullptr, nullptr, nullptr) != SQLITE_OK) {
+        ReportError("sqlite3_exec", sql);
+        return false;
+      }
+      return true;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void PackageDB::ReportError(const char *what, const char *sql) const
+    {
+      cerr << what << "(\"" << sql << "\") failed: " << sqlite3_errmsg(_db)
+           << " {" << __FILE__ << ':' << __LINE__ << "}\n";
+      return;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
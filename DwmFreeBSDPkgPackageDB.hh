@@ -0,0 +1,161 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgPackageDB.hh
+//!  \brief Dwm::FreeBSDPkg::PackageDB class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGPACKAGEDB_HH_
+#define _DWMFREEBSDPKGPACKAGEDB_HH_
+
+extern "C" {
+  #include <sqlite3.h>
+}
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DwmFreeBSDPkgManifest.hh"
+#include "DwmFreeBSDPkgPackageCache.hh"
+#include "DwmFreeBSDPkgPackageSource.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  A read-only session with the local pkg(8) database.  The database
+    //!  is opened once, and every query is a prepared statement with
+    //!  bound parameters that is kept for the life of the session.  If a
+    //!  PackageCache is attached, only what it doesn't already know is
+    //!  queried, and the answers are added to it.
+    //------------------------------------------------------------------------
+    class PackageDB
+      : public PackageSource
+    {
+    public:
+      static constexpr const char *k_defaultPath =
+        "/var/db/pkg/local.sqlite";
+      
+      PackageDB();
+      ~PackageDB() override;
+      PackageDB(const PackageDB &) = delete;
+      PackageDB & operator = (const PackageDB &) = delete;
+
+      //----------------------------------------------------------------------
+      //!  Opens the database at @c path, read-only.  Returns false (and
+      //!  reports the error on stderr) on failure.
+      //----------------------------------------------------------------------
+      bool Open(const std::string & path = k_defaultPath);
+
+      //----------------------------------------------------------------------
+      //!  Closes the database.
+      //----------------------------------------------------------------------
+      void Close();
+
+      //----------------------------------------------------------------------
+      //!  Returns true if the database is open.
+      //----------------------------------------------------------------------
+      bool IsOpen() const;
+      
+      //----------------------------------------------------------------------
+      //!  Returns the path of the database.
+      //----------------------------------------------------------------------
+      const std::string & Path() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the cache used for lookups, or nullptr if there is none.
+      //----------------------------------------------------------------------
+      PackageCache *Cache() const;
+
+      //----------------------------------------------------------------------
+      //!  Sets and returns the cache used for lookups.  Pass nullptr to
+      //!  query the database for everything.  The cache must outlive any
+      //!  lookups.
+      //----------------------------------------------------------------------
+      PackageCache *Cache(PackageCache *cache);
+      
+      //----------------------------------------------------------------------
+      //!  Returns the installed versions of the packages named in
+      //!  @c names, keyed by name, with a single query.  Packages that
+      //!  aren't installed are not in the returned map.
+      //----------------------------------------------------------------------
+      std::map<std::string,std::string>
+      InstalledVersions(const std::set<std::string> & names) override;
+
+      //----------------------------------------------------------------------
+      //!  Returns the installed packages that own any of @c paths, sorted
+      //!  by name, one entry per package name.  The paths are loaded into
+      //!  a temporary table and resolved with a single join.
+      //----------------------------------------------------------------------
+      std::vector<Manifest::Dependency>
+      PackagesForFiles(const std::set<std::string> & paths) override;
+
+      //----------------------------------------------------------------------
+      //!  Returns the dependency graph of the installed packages, read
+      //!  from the deps table with a single query.  This is not cached.
+      //----------------------------------------------------------------------
+      std::unordered_map<std::string,std::vector<std::string>>
+      DependencyGraph() override;
+      
+    private:
+      std::string    _path;
+      sqlite3       *_db;
+      PackageCache  *_cache;
+      sqlite3_stmt  *_insertNameStmt;
+      sqlite3_stmt  *_versionsForNamesStmt;
+      sqlite3_stmt  *_insertPathStmt;
+      sqlite3_stmt  *_packagesForPathsStmt;
+
+      sqlite3_stmt *Prepare(const char *sql);
+      bool Exec(const char *sql);
+      bool FillTempTable(const std::string & table,
+                         const std::string & column,
+                         sqlite3_stmt * & insertStmt,
+                         const std::set<std::string> & values);
+      void ReportError(const char *what, const char *sql) const;
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGPACKAGEDB_HH_
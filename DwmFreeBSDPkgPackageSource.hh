@@ -0,0 +1,97 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgPackageSource.hh
+//!  \brief Dwm::FreeBSDPkg::PackageSource class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGPACKAGESOURCE_HH_
+#define _DWMFREEBSDPKGPACKAGESOURCE_HH_
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DwmFreeBSDPkgManifest.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  Interface to a database of installed packages, which is all that
+    //!  dependency discovery needs to know about pkg(8).  PackageDB
+    //!  implements it with the local pkg database.
+    //------------------------------------------------------------------------
+    class PackageSource
+    {
+    public:
+      virtual ~PackageSource() = default;
+
+      //----------------------------------------------------------------------
+      //!  Returns the installed versions of the packages named in
+      //!  @c names, keyed by name.  Packages that aren't installed are not
+      //!  in the returned map.
+      //----------------------------------------------------------------------
+      virtual std::map<std::string,std::string>
+      InstalledVersions(const std::set<std::string> & names) = 0;
+
+      //----------------------------------------------------------------------
+      //!  Returns the installed packages that own any of @c paths, sorted
+      //!  by name, one entry per package name.  If more than one version
+      //!  of a package owns them, the lowest version is returned.
+      //----------------------------------------------------------------------
+      virtual std::vector<Manifest::Dependency>
+      PackagesForFiles(const std::set<std::string> & paths) = 0;
+
+      //----------------------------------------------------------------------
+      //!  Returns the dependency graph of the installed packages: the
+      //!  names of the direct dependencies of each package, keyed by
+      //!  package name.
+      //----------------------------------------------------------------------
+      virtual std::unordered_map<std::string,std::vector<std::string>>
+      DependencyGraph() = 0;
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGPACKAGESOURCE_HH_
@@ -0,0 +1,399 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgPathFilter.cc
+//!  \brief Dwm::FreeBSDPkg::PathFilter class implementation
+//---------------------------------------------------------------------------
+
+#include <fstream>
+
+#include "DwmFreeBSDPkgPathFilter.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    PathFilter::Glob::Glob(const string & pattern)
+        : _tokens(), _classes()
+    {
+      size_t  i = 0;
+      while (i < pattern.size()) {
+        char  c = pattern[i];
+        if (('\\' == c) && ((i + 1) < pattern.size())) {
+          _tokens.push_back({e_literal, pattern[i + 1], 0});
+          i += 2;
+        }
+        else if ('*' == c) {
+          if (((i + 1) < pattern.size()) && ('*' == pattern[i + 1])) {
+            i += 2;
+            while ((i < pattern.size()) && ('*' == pattern[i])) {
+              ++i;
+            }
+            if ((i < pattern.size()) && ('/' == pattern[i])) {
+              //  '**/' is '**' followed by '/', or nothing at all.
+              _tokens.push_back({e_skipDir, 0, 0});
+              _tokens.push_back({e_doubleStar, 0, 0});
+              _tokens.push_back({e_literal, '/', 0});
+              ++i;
+            }
+            else {
+              _tokens.push_back({e_doubleStar, 0, 0});
+            }
+          }
+          else {
+            _tokens.push_back({e_star, 0, 0});
+            ++i;
+          }
+        }
+        else if ('?' == c) {
+          _tokens.push_back({e_any, 0, 0});
+          ++i;
+        }
+        else if ('[' == c) {
+          //  Find the end of the class first, so an unterminated '[' can
+          //  be treated as a literal.
+          size_t  j = i + 1;
+          bool    negate = false;
+          if ((j < pattern.size()) && (('!' == pattern[j])
+                                       || ('^' == pattern[j]))) {
+            negate = true;
+            ++j;
+          }
+          size_t  first = j;
+          if ((j < pattern.size()) && (']' == pattern[j])) {
+            ++j;
+          }
+          while ((j < pattern.size()) && (']' != pattern[j])) {
+            ++j;
+          }
+          if (j >= pattern.size()) {
+            _tokens.push_back({e_literal, c, 0});
+            ++i;
+            continue;
+          }
+          bitset<256>  cls;
+          for (size_t k = first; k < j; ++k) {
+            unsigned char  lo = pattern[k];
+            if (((k + 2) < j) && ('-' == pattern[k + 1])) {
+              unsigned char  hi = pattern[k + 2];
+              for (unsigned int u = lo; u <= hi; ++u) {
+                cls.set(u);
+              }
+              k += 2;
+            }
+            else {
+              cls.set(lo);
+            }
+          }
+          if (negate) {
+            cls.flip();
+          }
+          _tokens.push_back({e_class, 0, _classes.size()});
+          _classes.push_back(cls);
+          i = j + 1;
+        }
+        else {
+          _tokens.push_back({e_literal, c, 0});
+          ++i;
+        }
+      }
+    }
+
+    //------------------------------------------------------------------------
+    //!  @c states[i] is nonzero if we could be about to match token i;
+    //!  @c states[_tokens.size()] means the whole pattern has matched.
+    //!  Each input character moves every live state at once, so there is
+    //!  never any backtracking.
+    //------------------------------------------------------------------------
+    bool PathFilter::Glob::Matches(const string & s) const
+    {
+      const size_t  n = _tokens.size();
+      vector<char>  states(n + 1, 0), next(n + 1, 0);
+      states[0] = 1;
+      Close(states);
+      for (char c : s) {
+        bool  live = false;
+        fill(next.begin(), next.end(), 0);
+        for (size_t i = 0; i < n; ++i) {
+          if (! states[i]) {
+            continue;
+          }
+          const Token  & tok = _tokens[i];
+          switch (tok.type) {
+            case e_literal:
+              if (c == tok.c) {
+                next[i + 1] = live = true;
+              }
+              break;
+            case e_any:
+              if ('/' != c) {
+                next[i + 1] = live = true;
+              }
+              break;
+            case e_class:
+              if (('/' != c) && _classes[tok.classIndex][(unsigned char)c]) {
+                next[i + 1] = live = true;
+              }
+              break;
+            case e_star:
+              if ('/' != c) {
+                next[i] = live = true;
+              }
+              break;
+            case e_doubleStar:
+              next[i] = live = true;
+              break;
+            case e_skipDir:
+              break;
+          }
+        }
+        if (! live) {
+          return false;
+        }
+        states.swap(next);
+        Close(states);
+      }
+      return states[n];
+    }
+
+    //------------------------------------------------------------------------
+    //!  Adds the states reachable without consuming input: stars may
+    //!  match nothing, and an e_skipDir may skip the '**/' it starts.
+    //------------------------------------------------------------------------
+    void PathFilter::Glob::Close(vector<char> & states) const
+    {
+      for (size_t i = 0; i < _tokens.size(); ++i) {
+        if (! states[i]) {
+          continue;
+        }
+        switch (_tokens[i].type) {
+          case e_star:
+          case e_doubleStar:
+            states[i + 1] = 1;
+            break;
+          case e_skipDir:
+            states[i + 1] = 1;
+            states[i + 3] = 1;
+            break;
+          default:
+            break;
+        }
+      }
+      return;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PathFilter::PatternSet::Empty() const
+    {
+      return (literalPaths.empty() && literalNames.empty()
+              && nameSuffixes.empty() && pathGlobs.empty()
+              && nameGlobs.empty());
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PathFilter::PatternSet::Matches(const string & path,
+                                         const string & name) const
+    {
+      if ((literalPaths.find(path) != literalPaths.end())
+          || (literalNames.find(name) != literalNames.end())) {
+        return true;
+      }
+      for (const auto & suffix : nameSuffixes) {
+        if ((name.size() >= suffix.size())
+            && (name.compare(name.size() - suffix.size(), suffix.size(),
+                             suffix) == 0)) {
+          return true;
+        }
+      }
+      for (const auto & glob : nameGlobs) {
+        if (glob.Matches(name)) {
+          return true;
+        }
+      }
+      for (const auto & glob : pathGlobs) {
+        if (glob.Matches(path)) {
+          return true;
+        }
+      }
+      return false;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    PathFilter::PathFilter()
+        : _excludeAny(), _excludeDirs(), _includeAny(), _includeDirs()
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void PathFilter::Exclude(const string & pattern)
+    {
+      Add(pattern, _excludeAny, _excludeDirs);
+      return;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void PathFilter::Include(const string & pattern)
+    {
+      Add(pattern, _includeAny, _includeDirs);
+      return;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PathFilter::Load(const string & path)
+    {
+      ifstream  is(path);
+      if (! is) {
+        return false;
+      }
+      string  line;
+      while (getline(is, line)) {
+        size_t  end = line.find_last_not_of(" \t\r");
+        if (end == string::npos) {
+          continue;
+        }
+        line.erase(end + 1);
+        if ('#' == line[0]) {
+          continue;
+        }
+        if ('!' == line[0]) {
+          Include(line.substr(1));
+        }
+        else {
+          Exclude(line);
+        }
+      }
+      return (! is.bad());
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PathFilter::Empty() const
+    {
+      return (_excludeAny.Empty() && _excludeDirs.Empty());
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PathFilter::Excluded(const string & path, bool isDir) const
+    {
+      if (Empty()) {
+        return false;
+      }
+      string  relPath((! path.empty() && ('/' == path[0]))
+                      ? path.substr(1) : path);
+      size_t  slash = relPath.find_last_of('/');
+      string  name((slash == string::npos)
+                   ? relPath : relPath.substr(slash + 1));
+      return (Matches(_excludeAny, _excludeDirs, relPath, name, isDir)
+              && (! Matches(_includeAny, _includeDirs, relPath, name,
+                            isDir)));
+    }
+
+    //------------------------------------------------------------------------
+    //!  Compiles @c pattern into @c any, or into @c dirs if it ends in
+    //!  '/'.
+    //------------------------------------------------------------------------
+    void PathFilter::Add(const string & pattern, PatternSet & any,
+                         PatternSet & dirs)
+    {
+      string  p(pattern);
+      bool    dirOnly = false;
+      while ((! p.empty()) && ('/' == p.back())) {
+        p.pop_back();
+        dirOnly = true;
+      }
+      bool  anchored = (p.find('/') != string::npos);
+      if (anchored) {
+        p.erase(0, p.find_first_not_of('/'));
+      }
+      if (p.empty()) {
+        return;
+      }
+      PatternSet  & ps = (dirOnly ? dirs : any);
+      if (p.find_first_of("*?[\\") == string::npos) {
+        if (anchored) {
+          ps.literalPaths.insert(p);
+        }
+        else {
+          ps.literalNames.insert(p);
+        }
+      }
+      else if ((! anchored) && ('*' == p[0]) && (p.size() > 1)
+               && (p.find_first_of("*?[\\", 1) == string::npos)) {
+        ps.nameSuffixes.push_back(p.substr(1));
+      }
+      else if (anchored) {
+        ps.pathGlobs.push_back(Glob(p));
+      }
+      else {
+        ps.nameGlobs.push_back(Glob(p));
+      }
+      return;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool PathFilter::Matches(const PatternSet & any, const PatternSet & dirs,
+                             const string & path, const string & name,
+                             bool isDir)
+    {
+      return (any.Matches(path, name) || (isDir && dirs.Matches(path, name)));
+    }
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
@@ -0,0 +1,183 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgPathFilter.hh
+//!  \brief Dwm::FreeBSDPkg::PathFilter class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGPATHFILTER_HH_
+#define _DWMFREEBSDPKGPATHFILTER_HH_
+
+#include <bitset>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  Decides which paths in a staging tree are excluded, from glob
+    //!  patterns compiled once up front.  Pattern syntax is a subset of
+    //!  gitignore(5):
+    //!
+    //!  - '*' matches any run of characters except '/', '?' matches one
+    //!    character except '/', and '[...]' matches one character from a
+    //!    set ('[!...]' or '[^...]' negates it).  '\' quotes the next
+    //!    character.
+    //!  - '**' matches any run of characters including '/', and '**/'
+    //!    also matches nothing, so 'a/**/b' matches 'a/b'.
+    //!  - A pattern ending in '/' only matches directories.
+    //!  - A pattern containing '/' (other than a trailing one) is matched
+    //!    against the whole path relative to the root of the tree; a
+    //!    leading '/' is optional.  Otherwise it is matched against the
+    //!    last component of the path, at any depth.
+    //!
+    //!  A path is excluded if it matches an exclude pattern and no include
+    //!  pattern.  Excluded directories are meant to be pruned by the
+    //!  caller, so include patterns can't bring back anything below them.
+    //!
+    //!  Patterns without wildcards are kept in hash sets, and '*suffix'
+    //!  patterns (like '*.o') in a list of suffixes, so the common cases
+    //!  never reach the glob matcher.  The glob matcher simulates the
+    //!  pattern's automaton over the path without backtracking, so its
+    //!  cost is linear in the length of the path.
+    //------------------------------------------------------------------------
+    class PathFilter
+    {
+    public:
+      //----------------------------------------------------------------------
+      //!  Constructs an empty filter, which excludes nothing.
+      //----------------------------------------------------------------------
+      PathFilter();
+
+      //----------------------------------------------------------------------
+      //!  Adds an exclude pattern.  Empty patterns are ignored.
+      //----------------------------------------------------------------------
+      void Exclude(const std::string & pattern);
+
+      //----------------------------------------------------------------------
+      //!  Adds an include pattern.  Empty patterns are ignored.
+      //----------------------------------------------------------------------
+      void Include(const std::string & pattern);
+
+      //----------------------------------------------------------------------
+      //!  Adds patterns from the file at @c path, one per line.  Empty
+      //!  lines and lines starting with '#' are ignored, and a line
+      //!  starting with '!' is an include pattern.  Returns false if the
+      //!  file could not be read.
+      //----------------------------------------------------------------------
+      bool Load(const std::string & path);
+
+      //----------------------------------------------------------------------
+      //!  Returns true if the filter has no patterns.
+      //----------------------------------------------------------------------
+      bool Empty() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns true if @c path (relative to the root of the tree, with
+      //!  a leading '/') is excluded.  @c isDir should be true if @c path
+      //!  is a directory.  Safe to call from several threads at once.
+      //----------------------------------------------------------------------
+      bool Excluded(const std::string & path, bool isDir) const;
+
+    private:
+      //----------------------------------------------------------------------
+      //!  A compiled glob.
+      //----------------------------------------------------------------------
+      class Glob
+      {
+      public:
+        Glob(const std::string & pattern);
+        bool Matches(const std::string & s) const;
+
+      private:
+        enum TokenType {
+          e_literal,        //  one specific character
+          e_any,            //  '?'
+          e_class,          //  '[...]'
+          e_star,           //  '*'
+          e_doubleStar,     //  '**'
+          e_skipDir         //  start of '**/', which may match nothing
+        };
+        struct Token {
+          TokenType  type;
+          char       c;
+          size_t     classIndex;
+        };
+        std::vector<Token>              _tokens;
+        std::vector<std::bitset<256>>   _classes;
+
+        void Close(std::vector<char> & states) const;
+      };
+
+      //----------------------------------------------------------------------
+      //!  The compiled patterns of one kind (exclude or include) that
+      //!  apply to one kind of path (any path, or directories only).
+      //----------------------------------------------------------------------
+      struct PatternSet
+      {
+        std::unordered_set<std::string>  literalPaths;
+        std::unordered_set<std::string>  literalNames;
+        std::vector<std::string>         nameSuffixes;
+        std::vector<Glob>                pathGlobs;
+        std::vector<Glob>                nameGlobs;
+
+        bool Empty() const;
+        bool Matches(const std::string & path,
+                     const std::string & name) const;
+      };
+
+      PatternSet  _excludeAny;
+      PatternSet  _excludeDirs;
+      PatternSet  _includeAny;
+      PatternSet  _includeDirs;
+
+      static void Add(const std::string & pattern, PatternSet & any,
+                      PatternSet & dirs);
+      static bool Matches(const PatternSet & any, const PatternSet & dirs,
+                          const std::string & path, const std::string & name,
+                          bool isDir);
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGPATHFILTER_HH_
@@ -0,0 +1,499 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgStagingTree.cc
+//!  \brief Dwm::FreeBSDPkg::StagingTree class implementation
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <dirent.h>
+  #include <fcntl.h>
+  #include <fts.h>
+  #include <unistd.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "DwmFreeBSDPkgStagingTree.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    using namespace std;
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    StagingTree::StagingTree(const string & dirName)
+        : _dirName(dirName), _filter(nullptr), _entries(), _index()
+    {}
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const string & StagingTree::DirName() const
+    {
+      return _dirName;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const PathFilter *StagingTree::Filter() const
+    {
+      return _filter;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const PathFilter *StagingTree::Filter(const PathFilter *filter)
+    {
+      _filter = filter;
+      return _filter;
+    }
+    
+    namespace {
+
+      struct DirNode;
+
+      //----------------------------------------------------------------------
+      //!  A directory entry read by the parallel walk.
+      //----------------------------------------------------------------------
+      struct DirChild
+      {
+        string               name;
+        struct stat          statbuf;
+        unique_ptr<DirNode>  dir;      //  non-null for directories
+      };
+
+      //----------------------------------------------------------------------
+      //!  A directory read by the parallel walk.  Children are kept in
+      //!  readdir() order, which is the order fts(3) uses when it isn't
+      //!  given a comparison function.
+      //----------------------------------------------------------------------
+      struct DirNode
+      {
+        bool              readable = false;
+        vector<DirChild>  children;
+      };
+
+      //----------------------------------------------------------------------
+      //!  A directory waiting to be read.  It is opened by @c relPath
+      //!  relative to the root of the walk when it's read, so queued
+      //!  directories don't hold descriptors.
+      //----------------------------------------------------------------------
+      struct DirWork
+      {
+        DirNode  *node;
+        string    relPath;
+      };
+
+      //----------------------------------------------------------------------
+      //!  Reads a directory tree with a pool of threads.  Each thread has
+      //!  its own deque of directories to read.  A thread pushes the
+      //!  subdirectories it finds onto the back of its own deque and
+      //!  pops from the back (depth first, which keeps the number of
+      //!  open directories down), and when its deque is empty it steals
+      //!  from the front of another thread's deque.  Each thread has at
+      //!  most one directory open at a time.  If any directory or entry
+      //!  can't be read, the walk fails; the first error is kept for
+      //!  Failed() and the remaining directories are skipped.
+      //----------------------------------------------------------------------
+      class ParallelWalker
+      {
+      public:
+        ParallelWalker(int rootFd, unsigned int numThreads,
+                       const PathFilter *filter)
+            : _rootFd(rootFd), _filter(filter), _queues(numThreads),
+              _pending(0), _failed(false), _errorMtx(), _error()
+        {}
+
+        void Run(DirNode *root)
+        {
+          Push(0, { root, "" });
+          vector<thread>  threads;
+          for (size_t i = 0; i < _queues.size(); ++i) {
+            threads.emplace_back([this, i] () { Work(i); });
+          }
+          for (auto & t : threads) {
+            t.join();
+          }
+          return;
+        }
+
+        //--------------------------------------------------------------------
+        //!  Returns true and sets @c error to a description of the first
+        //!  error if the walk failed.
+        //--------------------------------------------------------------------
+        bool Failed(string & error)
+        {
+          lock_guard<mutex>  lk(_errorMtx);
+          error = _error;
+          return _failed.load();
+        }
+        
+      private:
+        struct WorkQueue
+        {
+          mutex            mtx;
+          deque<DirWork>   work;
+        };
+        
+        int                 _rootFd;
+        const PathFilter   *_filter;
+        vector<WorkQueue>   _queues;
+        atomic<size_t>      _pending;
+        mutex               _idleMtx;
+        condition_variable  _idleCv;
+        atomic<bool>        _failed;
+        mutex               _errorMtx;
+        string              _error;
+
+        void Fail(const char *what, const string & relPath, int err)
+        {
+          lock_guard<mutex>  lk(_errorMtx);
+          if (! _failed.exchange(true)) {
+            _error = string(what) + "(\""
+              + (relPath.empty() ? string(".") : relPath) + "\") failed: "
+              + strerror(err);
+          }
+          return;
+        }
+
+        void Push(size_t self, DirWork && work)
+        {
+          ++_pending;
+          {
+            lock_guard<mutex>  lk(_queues[self].mtx);
+            _queues[self].work.push_back(std::move(work));
+          }
+          _idleCv.notify_one();
+          return;
+        }
+
+        bool Pop(size_t self, DirWork & work)
+        {
+          {
+            lock_guard<mutex>  lk(_queues[self].mtx);
+            if (! _queues[self].work.empty()) {
+              work = std::move(_queues[self].work.back());
+              _queues[self].work.pop_back();
+              return true;
+            }
+          }
+          for (size_t i = 1; i < _queues.size(); ++i) {
+            WorkQueue  & victim = _queues[(self + i) % _queues.size()];
+            lock_guard<mutex>  lk(victim.mtx);
+            if (! victim.work.empty()) {
+              work = std::move(victim.work.front());
+              victim.work.pop_front();
+              return true;
+            }
+          }
+          return false;
+        }
+        
+        void Work(size_t self)
+        {
+          DirWork  work;
+          while (_pending.load() > 0) {
+            if (Pop(self, work)) {
+              ReadDir(self, work);
+              if (--_pending == 0) {
+                _idleCv.notify_all();
+              }
+            }
+            else {
+              unique_lock<mutex>  lk(_idleMtx);
+              _idleCv.wait_for(lk, chrono::milliseconds(1));
+            }
+          }
+          return;
+        }
+
+        void ReadDir(size_t self, DirWork & work)
+        {
+          if (_failed.load()) {
+            return;
+          }
+          int  fd = openat(_rootFd,
+                           (work.relPath.empty() ? "." : work.relPath.c_str()),
+                           O_RDONLY|O_DIRECTORY|O_NOFOLLOW|O_CLOEXEC);
+          if (fd < 0) {
+            Fail("openat", work.relPath, errno);
+            return;
+          }
+          DIR  *dir = fdopendir(fd);
+          if (! dir) {
+            Fail("fdopendir", work.relPath, errno);
+            close(fd);
+            return;
+          }
+          work.node->readable = true;
+          
+          struct dirent  *dirEntry;
+          errno = 0;
+          while ((dirEntry = readdir(dir))) {
+            if ((strcmp(dirEntry->d_name, ".") == 0)
+                || (strcmp(dirEntry->d_name, "..") == 0)) {
+              continue;
+            }
+            DirChild  child;
+            child.name = dirEntry->d_name;
+            if (fstatat(dirfd(dir), dirEntry->d_name, &child.statbuf,
+                        AT_SYMLINK_NOFOLLOW) != 0) {
+              Fail("fstatat", (work.relPath.empty() ? child.name
+                               : (work.relPath + '/' + child.name)), errno);
+              break;
+            }
+            if (! (_filter
+                   && _filter->Excluded((work.relPath.empty() ? "/"
+                                         : ('/' + work.relPath + '/'))
+                                        + child.name,
+                                        S_ISDIR(child.statbuf.st_mode)))) {
+              work.node->children.push_back(std::move(child));
+            }
+            errno = 0;
+          }
+          if ((! dirEntry) && (errno != 0)) {
+            Fail("readdir", work.relPath, errno);
+          }
+          closedir(dir);
+          if (_failed.load()) {
+            return;
+          }
+          for (auto & child : work.node->children) {
+            if (S_ISDIR(child.statbuf.st_mode)) {
+              child.dir = make_unique<DirNode>();
+              string  relPath(work.relPath.empty() ? child.name
+                              : (work.relPath + '/' + child.name));
+              Push(self, { child.dir.get(), relPath });
+            }
+          }
+          return;
+        }
+      };
+
+    }  // anonymous namespace
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool StagingTree::Walk(unsigned int numThreads)
+    {
+      _entries.clear();
+      _index.clear();
+      if (0 == numThreads) {
+        numThreads = std::max(thread::hardware_concurrency(), 1U);
+      }
+      return ((numThreads > 1) ? WalkParallel(numThreads) : WalkFts());
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    bool StagingTree::WalkFts()
+    {
+      bool    rc = false;
+      string  path;
+      char  *dirs[2] = { strdup(_dirName.c_str()), 0 };
+      FTS  *fts = fts_open(&dirs[0],
+                           FTS_PHYSICAL|FTS_COMFOLLOW|FTS_NOCHDIR, 0);
+      if (fts) {
+        FTSENT  *ftsent;
+        rc = true;
+        errno = 0;
+        while (rc && (ftsent = fts_read(fts))) {
+          switch (ftsent->fts_info) {
+            case FTS_DNR:
+            case FTS_ERR:
+            case FTS_NS:
+              cerr << "fts_read(\"" << ftsent->fts_path << "\") failed: "
+                   << strerror(ftsent->fts_errno) << '\n';
+              rc = false;
+              break;
+            case FTS_D:
+              if (FTS_ROOTLEVEL == ftsent->fts_level) {
+                break;
+              }
+              // fallthrough
+            case FTS_F:
+            case FTS_SL:
+            case FTS_SLNONE:
+            case FTS_DEFAULT:
+              path = ftsent->fts_path;
+              if (path.find(_dirName) == 0) {
+                path = path.substr(_dirName.length());
+              }
+              if (path.front() != '/') {
+                path = "/" + path;
+              }
+              if (_filter
+                  && _filter->Excluded(path, (FTS_D == ftsent->fts_info))) {
+                if (FTS_D == ftsent->fts_info) {
+                  fts_set(fts, ftsent, FTS_SKIP);
+                }
+                break;
+              }
+              AddEntry(path, *(ftsent->fts_statp));
+              break;
+            default:
+              break;
+          }
+          errno = 0;
+        }
+        if (rc && (errno != 0)) {
+          cerr << "fts_read(\"" << _dirName << "\") failed: "
+               << strerror(errno) << '\n';
+          rc = false;
+        }
+        fts_close(fts);
+      }
+      else {
+        cerr << "fts_open(\"" << _dirName << "\") failed: "
+             << strerror(errno) << '\n';
+      }
+      free(dirs[0]);
+      return rc;
+    }
+
+    //------------------------------------------------------------------------
+    //!  Reads all directories concurrently into a tree of DirNodes, then
+    //!  flattens it depth first.  Since each directory's children are in
+    //!  readdir() order and each subdirectory's contents follow the
+    //!  subdirectory itself, the result is in fts(3) preorder no matter
+    //!  which thread read what.
+    //------------------------------------------------------------------------
+    bool StagingTree::WalkParallel(unsigned int numThreads)
+    {
+      //  Like FTS_COMFOLLOW in WalkFts(), follow the root if it's a
+      //  symlink.  Directories below it are opened with O_NOFOLLOW.
+      int  rootFd = open(_dirName.c_str(), O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+      if (rootFd < 0) {
+        cerr << "open(\"" << _dirName << "\") failed: " << strerror(errno)
+             << '\n';
+        return false;
+      }
+      DirNode         root;
+      ParallelWalker  walker(rootFd, numThreads, _filter);
+      walker.Run(&root);
+      close(rootFd);
+      string  error;
+      if (walker.Failed(error)) {
+        cerr << "Walk of " << _dirName << " failed: " << error << '\n';
+        _entries.clear();
+        _index.clear();
+        return false;
+      }
+
+      //  Flatten with an explicit stack to avoid deep recursion.
+      vector<pair<const DirNode *,size_t>>  stack;
+      vector<string>                        prefixes;
+      stack.push_back({&root, 0});
+      prefixes.push_back("");
+      while (! stack.empty()) {
+        auto  & top = stack.back();
+        if (top.second >= top.first->children.size()) {
+          stack.pop_back();
+          prefixes.pop_back();
+          continue;
+        }
+        const DirChild  & child = top.first->children[top.second++];
+        string  path(prefixes.back() + '/' + child.name);
+        if (S_ISDIR(child.statbuf.st_mode)) {
+          if (child.dir && child.dir->readable) {
+            AddEntry(path, child.statbuf);
+            stack.push_back({child.dir.get(), 0});
+            prefixes.push_back(path);
+          }
+        }
+        else {
+          AddEntry(path, child.statbuf);
+        }
+      }
+      return true;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    void StagingTree::AddEntry(const string & path,
+                               const struct stat & statbuf)
+    {
+      _index[path] = _entries.size();
+      _entries.push_back({path, statbuf});
+      return;
+    }
+    
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const vector<StagingTree::Entry> & StagingTree::Entries() const
+    {
+      return _entries;
+    }
+
+    //------------------------------------------------------------------------
+    //!  
+    //------------------------------------------------------------------------
+    const StagingTree::Entry *StagingTree::Find(const string & path) const
+    {
+      const Entry  *rc = nullptr;
+      auto  it = ((! path.empty()) && (path.front() == '/'))
+        ? _index.find(path) : _index.find("/" + path);
+      if (it != _index.end()) {
+        rc = &(_entries[it->second]);
+      }
+      return rc;
+    }
+    
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
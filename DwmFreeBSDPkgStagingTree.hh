@@ -0,0 +1,142 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+//---------------------------------------------------------------------------
+//!  \file DwmFreeBSDPkgStagingTree.hh
+//!  \brief Dwm::FreeBSDPkg::StagingTree class definition
+//---------------------------------------------------------------------------
+
+#ifndef _DWMFREEBSDPKGSTAGINGTREE_HH_
+#define _DWMFREEBSDPKGSTAGINGTREE_HH_
+
+extern "C" {
+  #include <sys/types.h>
+  #include <sys/stat.h>
+}
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DwmFreeBSDPkgPathFilter.hh"
+
+namespace Dwm {
+
+  namespace FreeBSDPkg {
+
+    //------------------------------------------------------------------------
+    //!  The contents of a directory tree, gathered with a single physical
+    //!  walk (symbolic links are not followed).  Every entry carries the
+    //!  lstat() data from the walk, so consumers (hashing, dependency
+    //!  scanning, missing file checks) never need to stat a path again.
+    //------------------------------------------------------------------------
+    class StagingTree
+    {
+    public:
+      //----------------------------------------------------------------------
+      //!  An entry in the tree.
+      //----------------------------------------------------------------------
+      struct Entry
+      {
+        std::string  path;     //!< relative to the tree, with leading '/'
+        struct stat  statbuf;  //!< from lstat()
+      };
+
+      //----------------------------------------------------------------------
+      //!  Construct for the tree rooted at @c dirName.  Does not walk the
+      //!  tree; call Walk() for that.
+      //----------------------------------------------------------------------
+      StagingTree(const std::string & dirName);
+
+      //----------------------------------------------------------------------
+      //!  Returns the root of the tree, as given to the constructor.
+      //----------------------------------------------------------------------
+      const std::string & DirName() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the filter used to exclude paths from the walk, or
+      //!  nullptr if there is none.
+      //----------------------------------------------------------------------
+      const PathFilter *Filter() const;
+
+      //----------------------------------------------------------------------
+      //!  Sets the filter used to exclude paths from the walk.  Excluded
+      //!  directories are pruned, so nothing below them is read.  The
+      //!  filter must outlive any calls to Walk().
+      //----------------------------------------------------------------------
+      const PathFilter *Filter(const PathFilter *filter);
+
+      //----------------------------------------------------------------------
+      //!  Walks the tree, replacing any previously gathered entries.
+      //!  With more than one thread (0 means one per online CPU),
+      //!  directories are read concurrently by worker threads that steal
+      //!  work from each other, using openat() and fstatat() relative to
+      //!  the directory being read.  Either way, entries are kept in the
+      //!  order fts(3) would return them, the root is followed if it is
+      //!  a symlink and symlinks below it are not.  Returns false (after
+      //!  reporting why on stderr) if any directory or entry could not
+      //!  be read, rather than leaving part of the tree out.
+      //----------------------------------------------------------------------
+      bool Walk(unsigned int numThreads = 1);
+
+      //----------------------------------------------------------------------
+      //!  Returns all entries in the tree except the root, including
+      //!  directories.
+      //----------------------------------------------------------------------
+      const std::vector<Entry> & Entries() const;
+
+      //----------------------------------------------------------------------
+      //!  Returns the entry with the given @c path (relative to the tree,
+      //!  with or without a leading '/'), or nullptr if there is none.
+      //----------------------------------------------------------------------
+      const Entry *Find(const std::string & path) const;
+
+    private:
+      std::string                              _dirName;
+      const PathFilter                        *_filter;
+      std::vector<Entry>                       _entries;
+      std::unordered_map<std::string,size_t>  _index;
+
+      bool WalkFts();
+      bool WalkParallel(unsigned int numThreads);
+      void AddEntry(const std::string & path, const struct stat & statbuf);
+    };
+
+  }  // namespace FreeBSDPkg
+
+}  // namespace Dwm
+
+#endif  // _DWMFREEBSDPKGSTAGINGTREE_HH_
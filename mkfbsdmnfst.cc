@@ -41,16 +41,13 @@
 
 extern "C" {
   #include <fcntl.h>
-  #include <fts.h>
   #include <libgen.h>
-  #include <openssl/evp.h>
-  #include <openssl/sha.h>
   #include <sys/types.h>
   #include <sys/stat.h>
   #include <sys/utsname.h>
   #include <unistd.h>
-  #include <sqlite3.h>
 }
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
@@ -58,32 +55,62 @@ extern "C" {
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <regex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "DwmArguments.hh"
+#include "DwmFreeBSDPkgFileHasher.hh"
+#include "DwmFreeBSDPkgDependencyScanner.hh"
+#include "DwmFreeBSDPkgHashCache.hh"
 #include "DwmFreeBSDPkgManifest.hh"
+#include "DwmFreeBSDPkgPackageCache.hh"
+#include "DwmFreeBSDPkgPackageDB.hh"
+#include "DwmFreeBSDPkgPathFilter.hh"
+#include "DwmFreeBSDPkgStagingTree.hh"
 
 using namespace std;
 namespace fs = std::filesystem;
 
+using Dwm::FreeBSDPkg::DependencyScanner;
 using Dwm::FreeBSDPkg::Manifest;
+using Dwm::FreeBSDPkg::PackageCache;
+using Dwm::FreeBSDPkg::PackageDB;
+using Dwm::FreeBSDPkg::PackageSource;
+using Dwm::FreeBSDPkg::PathFilter;
+using Dwm::FreeBSDPkg::StagingTree;
 
-typedef   Dwm::Arguments<Dwm::Argument<'c',string>,
+typedef   Dwm::Arguments<Dwm::Argument<'a',bool>,
+                         Dwm::Argument<'C',string>,
+                         Dwm::Argument<'c',string>,
+                         Dwm::Argument<'D',string>,
                          Dwm::Argument<'d',string>,
                          Dwm::Argument<'g',string>,
+                         Dwm::Argument<'H',bool>,
+                         Dwm::Argument<'i',vector<string>>,
+                         Dwm::Argument<'j',unsigned int>,
+                         Dwm::Argument<'M',string>,
                          Dwm::Argument<'m',string>,
                          Dwm::Argument<'n',string>,
                          Dwm::Argument<'o',string>,
+                         Dwm::Argument<'P',string>,
                          Dwm::Argument<'p',string>,
                          Dwm::Argument<'r',string>,
+                         Dwm::Argument<'S',bool>,
                          Dwm::Argument<'s',string,true>,
+                         Dwm::Argument<'T',bool>,
+                         Dwm::Argument<'t',unsigned int>,
                          Dwm::Argument<'u',string>,
                          Dwm::Argument<'v',string>,
-                         Dwm::Argument<'w',string>> MyArgType;
+                         Dwm::Argument<'w',string>,
+                         Dwm::Argument<'X',string>,
+                         Dwm::Argument<'x',vector<string>>> MyArgType;
 static MyArgType  g_args;
 
 //----------------------------------------------------------------------------
@@ -91,26 +118,66 @@ static MyArgType  g_args;
 //----------------------------------------------------------------------------
 static void InitArgs()
 {
+  g_args.SetHelp<'a'>("Read files with asynchronous I/O while hashing them,"
+                      " keeping several reads in flight per thread");
+  g_args.SetValueName<'C'>("cachedir");
+  g_args.SetHelp<'C'>("Keep the hash and package database caches in the"
+                      " given directory (implies -H)");
   g_args.SetValueName<'c'>("comment");
   g_args.SetHelp<'c'>("Set the comment ('comment:') value");
+  g_args.SetValueName<'D'>("format");
+  g_args.SetHelp<'D'>("Instead of a manifest, print a report of staged"
+                      " files with identical contents, in the given format"
+                      " ('text' or 'json')");
   g_args.SetValueName<'d'>("desc");
   g_args.SetHelp<'d'>("Set the description ('desc:') value");
   g_args.SetValueName<'g'>("group");
   g_args.Set<'g'>("wheel");
   g_args.SetHelp<'g'>("Set the group ID of files (default is 'wheel')");
+  g_args.SetHelp<'H'>("Keep a cache of file checksums next to the staging"
+                      " directory, and only hash files that changed since"
+                      " the previous run.  Also cache package database"
+                      " lookups until the database changes.");
+  g_args.SetValueName<'i'>("patterns");
+  g_args.SetHelp<'i'>("Comma-separated glob patterns of staged paths to"
+                      " keep even if they match an exclude pattern");
+  g_args.SetValueName<'j'>("jobs");
+  g_args.SetHelp<'j'>("Number of threads used to walk directories, hash"
+                      " files and scan for dependencies (default is one per"
+                      " CPU)");
+  g_args.SetValueName<'M'>("size");
+  g_args.Set<'M'>("16m");
+  g_args.SetHelp<'M'>("Hash files of at least size bytes (suffix k, m or g"
+                      " allowed) through mmap() instead of read().  0"
+                      " disables mmap().  Default is 16m.");
   g_args.SetValueName<'m'>("maintainer");
   g_args.SetHelp<'m'>("Set the maintainer's email address");
   g_args.SetValueName<'n'>("name");
   g_args.SetHelp<'n'>("Set the name of the package (e.g. 'libFooBar')");
   g_args.SetValueName<'o'>("origin");
   g_args.SetHelp<'o'>("Set the origin (e.g. 'devel/libFooBar')");
+  g_args.SetValueName<'P'>("pkgdb");
+  g_args.Set<'P'>(PackageDB::k_defaultPath);
+  g_args.SetHelp<'P'>("Look up installed packages in the given pkg database"
+                      " (default is /var/db/pkg/local.sqlite)");
   g_args.SetValueName<'p'>("prefix");
   g_args.SetHelp<'p'>("Set the path where files will be installed");
   g_args.SetValueName<'r'>("manifest");
   g_args.SetHelp<'r'>("Read the given manifest file and ingest its settings");
+  g_args.SetHelp<'S'>("Hash and write the staged files in batches instead"
+                      " of holding all of them in memory until the"
+                      " manifest is emitted");
   g_args.SetValueName<'s'>("directory");
   g_args.SetHelp<'s'>("Staging directory where files to be packaged are"
                       " located");
+  g_args.SetHelp<'T'>("Don't add discovered dependencies that another"
+                      " dependency already requires, directly or"
+                      " indirectly");
+  g_args.SetValueName<'t'>("seconds");
+  g_args.Set<'t'>(60);
+  g_args.SetHelp<'t'>("Give up on scanning any one file for dependencies"
+                      " after the given number of seconds, and report it"
+                      " (default 60, 0 means never)");
   g_args.Set<'u'>("root");
   g_args.SetValueName<'u'>("user");
   g_args.SetHelp<'u'>("Set the owner of files (default is 'root')");
@@ -118,236 +185,465 @@ static void InitArgs()
   g_args.SetHelp<'v'>("Set the version (e.g. '1.5.2')");
   g_args.SetValueName<'w'>("URL");
   g_args.SetHelp<'w'>("Set the software's official web site");
+  g_args.SetValueName<'X'>("file");
+  g_args.SetHelp<'X'>("Read exclude patterns from the given file, one per"
+                      " line ('!' at the start of a line makes it an"
+                      " include pattern)");
+  g_args.SetValueName<'x'>("patterns");
+  g_args.SetHelp<'x'>("Comma-separated glob patterns of staged paths to"
+                      " leave out of the package.  Excluded directories"
+                      " are not traversed.");
 }
 
 //----------------------------------------------------------------------------
-//!  
+//!  Parses a byte count with an optional k, m or g suffix (powers of
+//!  1024).  Returns false if @c s is not a valid byte count.
 //----------------------------------------------------------------------------
-static void GetSharedLibs(const string & filename, set<string> & libs)
-{
-  string  lddcmd("ldd " + filename + " 2>/dev/null");
-  FILE    *lddpipe = popen(lddcmd.c_str(), "r");
-  if (lddpipe) {
-    regex   rgx(".+[ \\t]+[=][>][ \\t]+([^ \\t]+)[ \\t]+",
-                regex::ECMAScript|regex::optimize);
-    smatch  sm;
-    char    line[4096];
-    while (fgets(line, 4096, lddpipe) != NULL) {
-      string  s(line);
-      if (regex_search(s, sm, rgx)) {
-        if (sm.size() == 2) {
-          string  lib(sm[1].str());
-          libs.insert(lib);
-        }
-      }
+static bool ParseByteCount(const string & s, uint64_t & bytes)
+{
+  bool  rc = false;
+  char  *endptr = nullptr;
+  if ((! s.empty()) && isdigit(s.front())) {
+    bytes = strtoull(s.c_str(), &endptr, 10);
+    switch (tolower(*endptr)) {
+      case 'g':  bytes <<= 10;  // fallthrough
+      case 'm':  bytes <<= 10;  // fallthrough
+      case 'k':  bytes <<= 10;  ++endptr;  break;
+      default:                             break;
     }
-    pclose(lddpipe);
+    rc = ('\0' == *endptr);
   }
-  return;
+  return rc;
 }
 
+typedef Dwm::FreeBSDPkg::StagingTree::Entry  StagedFile;
+
 //----------------------------------------------------------------------------
-//!  
+//!  Returns true if @c path is an editor backup of one of the special
+//!  files at the top of the staging directory, like '/+MANIFEST~' or
+//!  '/#+DESC#'.
+//----------------------------------------------------------------------------
+static bool IsSpecialFileBackup(const string & path)
+{
+  static const vector<string>  specialNames = {
+    "+DESC", "+DISPLAY", "+MANIFEST", "+PRE_DEINSTALL", "+POST_DEINSTALL",
+    "+PRE_INSTALL", "+POST_INSTALL"
+  };
+  if (path.find('/', 1) != string::npos) {
+    return false;
+  }
+  size_t  start = path.find_first_not_of("/#");
+  if ((start == string::npos) || (start == 0)) {
+    return false;
+  }
+  for (const auto & name : specialNames) {
+    if ((path.compare(start, name.size(), name) == 0)
+        && (path.size() > (start + name.size()))
+        && (path.find_first_not_of("~#", start + name.size())
+            == string::npos)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns true if @c entry is a regular file or symbolic link that
+//!  isn't a backup copy of a special file.  Paths excluded with -x or -X
+//!  were already left out of the walk.
+//----------------------------------------------------------------------------
+static bool IsPackageFile(const StagedFile & entry)
+{
+  return ((S_ISREG(entry.statbuf.st_mode) || S_ISLNK(entry.statbuf.st_mode))
+          && (! IsSpecialFileBackup(entry.path)));
+}
+
+//----------------------------------------------------------------------------
+//!  Returns the regular files and symbolic links in the staging tree,
+//!  minus backup copies of the special files.
+//----------------------------------------------------------------------------
+static vector<StagedFile> GetFiles(const StagingTree & stagingTree)
+{
+  vector<StagedFile>  files;
+  for (const auto & entry : stagingTree.Entries()) {
+    if (IsPackageFile(entry)) {
+      files.push_back(entry);
+    }
+  }
+  return files;
+}
+
 //----------------------------------------------------------------------------
-static string GetInstalledPackageVersion(string packageName)
-{
-  string rc;
-  string  query("select packages.version from packages");
-  query += " where packages.name = '" + packageName + "'";
-  sqlite3  *ppdb = nullptr;
-  if (sqlite3_open_v2("file:/var/db/pkg/local.sqlite?immutable=1",
-                      &ppdb, SQLITE_OPEN_READONLY|SQLITE_OPEN_URI, 0)
-      == SQLITE_OK) {
-    sqlite3_stmt *ppStmt;
-    if (sqlite3_prepare(ppdb, query.c_str(), -1, &ppStmt, 0) == SQLITE_OK) {
-      if (sqlite3_step(ppStmt) == SQLITE_ROW) {
-        rc = (const char *)sqlite3_column_text(ppStmt, 0);
+//!  Returns the path of the cache file with the given @c suffix for the
+//!  staging directory @c dirName, or an empty string if caches are not
+//!  in use.  The cache lives next to the staging directory unless a
+//!  cache directory was given, in which case its name is the staging
+//!  directory's real path with '/' replaced by '%'.
+//----------------------------------------------------------------------------
+static string StagingCachePath(const string & dirName, const string & suffix)
+{
+  string  rc;
+  if (g_args.Get<'H'>() || (! g_args.Get<'C'>().empty())) {
+    char  *realDir = realpath(dirName.c_str(), nullptr);
+    if (realDir) {
+      fs::path  stagingPath(realDir);
+      free(realDir);
+      if (stagingPath.has_filename()) {
+        if (! g_args.Get<'C'>().empty()) {
+          string  name(stagingPath.string());
+          replace(name.begin(), name.end(), '/', '%');
+          rc = (fs::path(g_args.Get<'C'>()) / (name + suffix)).string();
+        }
+        else {
+          rc = (stagingPath.parent_path()
+                / ("." + stagingPath.filename().string() + suffix)).string();
+        }
       }
-      sqlite3_finalize(ppStmt);
     }
-    else {
-      cerr << "sqlite3_prepare(\"" << query << "\") failed: "
-           << sqlite3_errmsg(ppdb) << " {" << __FILE__ << ':' << __LINE__
-           << "}\n";
+  }
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns the path of the hash cache file for the staging directory
+//!  @c dirName, or an empty string if the hash cache is not in use.
+//----------------------------------------------------------------------------
+static string HashCachePath(const string & dirName)
+{
+  return StagingCachePath(dirName, ".hashcache");
+}
+
+//----------------------------------------------------------------------------
+//!  Returns the path of the package cache file for the pkg database
+//!  @c dbPath, or an empty string if caches are not in use.  Without a
+//!  cache directory it lives next to the staging directory @c dirName.
+//!  In a cache directory, its name is the database's real path with '/'
+//!  replaced by '%', so every staging directory shares it.
+//----------------------------------------------------------------------------
+static string PackageCachePath(const string & dirName, const string & dbPath)
+{
+  string  rc;
+  if (! g_args.Get<'C'>().empty()) {
+    char  *realDB = realpath(dbPath.c_str(), nullptr);
+    if (realDB) {
+      string  name(realDB);
+      free(realDB);
+      replace(name.begin(), name.end(), '/', '%');
+      rc = (fs::path(g_args.Get<'C'>()) / (name + ".pkgcache")).string();
     }
-    sqlite3_close_v2(ppdb);
   }
   else {
-    cerr << "sqlite3_open_v2(\"/var/db/pkg/local.sqlite\") failed {"
-         << __FILE__ << ':' << __LINE__ << "}\n";
+    rc = StagingCachePath(dirName, ".pkgcache");
   }
   return rc;
 }
 
 //----------------------------------------------------------------------------
-//!  
+//!  Attaches the package cache for the staging directory @c dirName to
+//!  @c packageDB, if caches are in use.  Returns the cache, which must be
+//!  kept until @c packageDB is done with it.
 //----------------------------------------------------------------------------
-static void GetPackageDeps(const set<string> & libs,
-                           set<pair<string,string>> & packages)
-{
-  string  queryPreamble("select packages.name, packages.version, packages.id,"
-                        " files.package_id, files.path"
-                        " from packages, files where"
-                        " packages.id = files.package_id"
-                        " and files.path = ");
-  sqlite3  *ppdb = nullptr;
-  if (sqlite3_open_v2("file:/var/db/pkg/local.sqlite?immutable=1", &ppdb,
-                      SQLITE_OPEN_READONLY|SQLITE_OPEN_URI, 0)
-      == SQLITE_OK) {
-    for (auto lib : libs) {
-      string  qrystr(queryPreamble + '\'' + lib + '\'');
-      sqlite3_stmt *ppStmt;
-      if (sqlite3_prepare_v2(ppdb, qrystr.c_str(), -1, &ppStmt, 0) == SQLITE_OK) {
-        while (sqlite3_step(ppStmt) == SQLITE_ROW) {
-          string  pkgName((const char *)sqlite3_column_text(ppStmt, 0));
-          string  pkgVersion((const char *)sqlite3_column_text(ppStmt, 1));
-          packages.insert({pkgName,pkgVersion});
-        }
-      }
-      else {
-        cerr << "sqlite3_prepare_v2(\"" << qrystr << "\") failed: "
-             << sqlite3_errmsg(ppdb) << " {" << __FILE__ << ':' << __LINE__
-             << "}\n";
-      }
-      sqlite3_finalize(ppStmt);
+static unique_ptr<PackageCache> AttachPackageCache(const string & dirName,
+                                                   PackageDB & packageDB)
+{
+  unique_ptr<PackageCache>  rc;
+  string                    cachePath =
+    PackageCachePath(dirName, packageDB.Path());
+  struct stat               dbStat;
+  if ((! cachePath.empty())
+      && (stat(packageDB.Path().c_str(), &dbStat) == 0)) {
+    rc = make_unique<PackageCache>(cachePath);
+    if (! rc->Load(dbStat)) {
+      cerr << "Ignoring unreadable package cache " << cachePath << '\n';
     }
-    sqlite3_close_v2(ppdb);
+    packageDB.Cache(rc.get());
   }
-  else {
-    cerr << "sqlite3_open_v2(\"/var/db/pkg/local.sqlite\") failed {"
-         << __FILE__ << ':' << __LINE__ << "}\n";
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  Reports on the lookups in @c cache and saves it.
+//----------------------------------------------------------------------------
+static void FinishPackageCache(PackageCache & cache)
+{
+  cerr << "Package cache " << cache.Path() << ": " << cache.Hits()
+       << " hits, " << cache.Misses() << " misses\n";
+  if (! cache.Save()) {
+    cerr << "Failed to save package cache " << cache.Path() << '\n';
   }
   return;
 }
 
 //----------------------------------------------------------------------------
-//!  
+//!  State kept across calls to GetDigests() when files are hashed in
+//!  batches.
 //----------------------------------------------------------------------------
-static void GetPackageInfo(const set<pair<string,string>> & pkgs,
-                           vector<Manifest::Dependency> & pkginfo)
-{
-  sqlite3  *ppdb = nullptr;
-  if (sqlite3_open_v2("file:/var/db/pkg/local.sqlite?immutable=1",
-                      &ppdb, SQLITE_OPEN_READONLY|SQLITE_OPEN_URI, 0)
-      == SQLITE_OK) {
-    for (auto pkg : pkgs) {
-      string query = "select packages.name,packages.origin,packages.version"
-        " from packages where packages.name = '" + pkg.first + "' and"
-        " packages.version = '" + pkg.second + "'";
-      sqlite3_stmt *ppStmt;
-      if (sqlite3_prepare(ppdb, query.c_str(), -1, &ppStmt, 0) == SQLITE_OK) {
-        if (sqlite3_step(ppStmt) == SQLITE_ROW) {
-          Manifest::Dependency  dep((const char *)sqlite3_column_text(ppStmt, 0),
-                                    (const char *)sqlite3_column_text(ppStmt, 1),
-                                    (const char *)sqlite3_column_text(ppStmt, 2));
-          if (find_if(pkginfo.begin(), pkginfo.end(),
-                        [&] (Manifest::Dependency const & item)
-                        { return dep.Name() == item.Name(); })
-                == pkginfo.end()) {
-              pkginfo.push_back(dep);
-          }
-        }
-        sqlite3_finalize(ppStmt);
+struct DigestState
+{
+  string                                   dirName;
+  string                                   cachePath;
+  unique_ptr<Dwm::FreeBSDPkg::HashCache>   cache;
+  map<pair<dev_t,ino_t>,string>            linkedDigests;
+  size_t                                   hardLinks = 0;
+  uint64_t                                 hardLinkBytes = 0;
+};
+
+//----------------------------------------------------------------------------
+//!  Prepares @c state for hashing files in the staging directory
+//!  @c dirName, loading the hash cache if it's in use.
+//----------------------------------------------------------------------------
+static void StartDigests(const string & dirName, DigestState & state)
+{
+  state.dirName = dirName;
+  //  Only hash the files whose identity isn't in the hash cache.
+  state.cachePath = HashCachePath(dirName);
+  if (! state.cachePath.empty()) {
+    state.cache = make_unique<Dwm::FreeBSDPkg::HashCache>(state.cachePath);
+    if (! state.cache->Load()) {
+      cerr << "Ignoring unreadable hash cache " << state.cachePath << '\n';
+    }
+  }
+  return;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns the digests of @c files, in the same order.  May be called
+//!  several times with successive batches of files from the same tree;
+//!  hard-linked inodes are still only hashed once.
+//----------------------------------------------------------------------------
+static vector<string> GetDigests(DigestState & state,
+                                 const vector<StagedFile> & files)
+{
+  vector<string>  digests(files.size());
+
+  //  Of the files not in the hash cache, only hash one path per
+  //  hard-linked inode.  The other paths to the same inode get its
+  //  digest.
+  vector<size_t>                 toHash;
+  vector<string>                 paths;
+  map<pair<dev_t,ino_t>,size_t>  hashedInodes;  //  index into toHash
+  vector<pair<size_t,size_t>>    hardLinks;     //  file index, toHash index
+  for (size_t i = 0; i < files.size(); ++i) {
+    const struct stat  & statbuf = files[i].statbuf;
+    if (state.cache && state.cache->Find(statbuf, digests[i])) {
+      continue;
+    }
+    if (S_ISREG(statbuf.st_mode) && (statbuf.st_nlink > 1)) {
+      pair<dev_t,ino_t>  inode(statbuf.st_dev, statbuf.st_ino);
+      auto  lit = state.linkedDigests.find(inode);
+      if (lit != state.linkedDigests.end()) {
+        digests[i] = lit->second;
+        ++state.hardLinks;
+        state.hardLinkBytes += statbuf.st_size;
+        continue;
       }
-      else {
-        cerr << "sqlite3_prepare(\"" << query << "\") failed: "
-             << sqlite3_errmsg(ppdb) << " {" << __FILE__ << ':' << __LINE__
-             << "}\n";
+      auto  it = hashedInodes.find(inode);
+      if (it != hashedInodes.end()) {
+        hardLinks.push_back({i, it->second});
+        ++state.hardLinks;
+        state.hardLinkBytes += statbuf.st_size;
+        continue;
       }
+      hashedInodes[inode] = toHash.size();
     }
-    sqlite3_close_v2(ppdb);
+    toHash.push_back(i);
+    paths.push_back(state.dirName + files[i].path);
   }
-  else {
-    cerr << "sqlite3_open_v2(\"/var/db/pkg/local.sqlite\") failed {"
-         << __FILE__ << ':' << __LINE__ << "}\n";
+  
+  Dwm::FreeBSDPkg::FileHasher  hasher(g_args.Get<'j'>());
+  uint64_t  mmapThreshold;
+  if (ParseByteCount(g_args.Get<'M'>(), mmapThreshold)) {
+    hasher.MmapThreshold(mmapThreshold);
   }
-  return;
+  hasher.AsyncReads(g_args.Get<'a'>());
+  vector<string>  hashed = hasher.Hash(paths);
+  for (size_t i = 0; i < toHash.size(); ++i) {
+    digests[toHash[i]] = hashed[i];
+    if (state.cache) {
+      state.cache->Add(files[toHash[i]].statbuf, hashed[i]);
+    }
+  }
+  for (const auto & hardLink : hardLinks) {
+    digests[hardLink.first] = hashed[hardLink.second];
+  }
+  //  Remember hard-linked inodes for later batches.
+  for (const auto & hashedInode : hashedInodes) {
+    state.linkedDigests[hashedInode.first] = hashed[hashedInode.second];
+  }
+  return digests;
 }
 
 //----------------------------------------------------------------------------
-//!  
+//!  Reports on the hashing done with @c state and saves the hash cache.
 //----------------------------------------------------------------------------
-vector<string> GetFiles(const string & dirName)
-{
-  regex              excludeRegex("^[/][#]*\\+(DESC|DISPLAY|MANIFEST|PRE_DEINSTALL|POST_DEINSTALL|PRE_INSTALL|POST_INSTALL)[~#]+");
-  vector<string>     filenames;
-  string             filename;
-  string::size_type  idx;
-  char  *dirs[2] = { strdup(dirName.c_str()), 0 };
-  FTS  *fts = fts_open(&dirs[0], FTS_PHYSICAL|FTS_NOCHDIR, 0);
-  if (fts) {
-    FTSENT  *ftsent;
-    while ((ftsent = fts_read(fts))) {
-      switch (ftsent->fts_info) {
-        case FTS_F:
-        case FTS_SL:
-          filename = ftsent->fts_path;
-          idx = filename.find(dirName);
-          if (idx == 0) {
-            filename = filename.substr(dirName.length());
-          }
-          if (filename.front() != '/') {
-            filename = "/" + filename;
-          }
-          if (! regex_match(filename, excludeRegex)) {
-            filenames.push_back(filename);
-          }
-          break;
-        default:
-          break;
-      }
+static void FinishDigests(DigestState & state)
+{
+  if (state.hardLinks) {
+    cerr << "Skipped hashing " << state.hardLinks << " hard links to "
+         << "already hashed files (" << state.hardLinkBytes << " bytes)\n";
+  }
+  if (state.cache) {
+    cerr << "Hash cache " << state.cachePath << ": " << state.cache->Hits()
+         << " hits, " << state.cache->Misses() << " misses\n";
+    if (! state.cache->Save()) {
+      cerr << "Failed to save hash cache " << state.cachePath << '\n';
     }
-    fts_close(fts);
   }
-  free(dirs[0]);
-  return filenames;
+  return;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns the digests of @c files in the staging directory @c dirName,
+//!  in the same order.
+//----------------------------------------------------------------------------
+static vector<string> GetDigests(const string & dirName,
+                                 const vector<StagedFile> & files)
+{
+  DigestState  state;
+  StartDigests(dirName, state);
+  vector<string>  digests = GetDigests(state, files);
+  FinishDigests(state);
+  return digests;
 }
 
 //----------------------------------------------------------------------------
 //!  
 //----------------------------------------------------------------------------
-static string GetSHA256(const string & filename)
-{
-  unsigned char  md[SHA_DIGEST_LENGTH];
-  memset(md, 0, sizeof(md));
-  int fd = open(filename.c_str(), O_RDONLY);
-  if (fd >= 0) {
-    EVP_MD_CTX  *sha1_ctx = EVP_MD_CTX_new();
-    if (sha1_ctx) {
-      EVP_DigestInit(sha1_ctx, EVP_sha1());
-      uint8_t  buf[65536];
-      ssize_t  bytesRead;
-      while ((bytesRead = read(fd, buf, 65536)) > 0) {
-        EVP_DigestUpdate(sha1_ctx, buf, bytesRead);
-      }
-      EVP_DigestFinal(sha1_ctx, &(md[0]), nullptr);
-      EVP_MD_CTX_free(sha1_ctx);
-    }
-    close(fd);
+vector<Manifest::File> GetManifestFiles(const StagingTree & stagingTree)
+{
+  vector<Manifest::File>  rc;
+  vector<StagedFile>      files = GetFiles(stagingTree);
+  vector<string>          digests = GetDigests(stagingTree.DirName(), files);
+  rc.reserve(files.size());
+  for (size_t i = 0; i < files.size(); ++i) {
+    rc.push_back(Manifest::File(files[i].path, digests[i]));
   }
+  return rc;
+}
 
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+static string JSONEscape(const string & s)
+{
   ostringstream  os;
-  os << setfill('0') << hex;
-  for (int i = 0; i < SHA_DIGEST_LENGTH; ++i) {
-    os << setw(2) << (uint16_t)md[i];
+  for (unsigned char c : s) {
+    switch (c) {
+      case '"':   os << "\\\"";  break;
+      case '\\':  os << "\\\\";  break;
+      case '\n':  os << "\\n";   break;
+      case '\t':  os << "\\t";   break;
+      default:
+        if (c < 0x20) {
+          os << "\\u" << hex << setw(4) << setfill('0') << (int)c << dec;
+        }
+        else {
+          os << c;
+        }
+        break;
+    }
   }
   return os.str();
 }
 
 //----------------------------------------------------------------------------
-//!  
+//!  A set of staged regular files with identical contents.
 //----------------------------------------------------------------------------
-vector<Manifest::File> GetManifestFiles(const string & dirName)
+struct DuplicateGroup
 {
-  vector<Manifest::File>  rc;
-  vector<string>  filenames = GetFiles(dirName);
-  for (auto f : filenames) {
-    Manifest::File  mf(f, GetSHA256(dirName + f));
-    rc.push_back(mf);
+  string          digest;
+  uint64_t        size;
+  uint64_t        duplicatedBytes;
+  vector<string>  paths;
+};
+
+//----------------------------------------------------------------------------
+//!  Groups the staged regular files by digest and returns the groups
+//!  whose contents are stored more than once, largest waste first.
+//!  Paths that are hard links to the same inode share one copy of the
+//!  contents, so they don't count as duplicated bytes.
+//----------------------------------------------------------------------------
+static vector<DuplicateGroup>
+FindDuplicates(const vector<StagedFile> & files,
+               const vector<string> & digests)
+{
+  map<string,vector<size_t>>  byDigest;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (S_ISREG(files[i].statbuf.st_mode) && (files[i].statbuf.st_size > 0)
+        && (! digests[i].empty())) {
+      byDigest[digests[i]].push_back(i);
+    }
+  }
+  vector<DuplicateGroup>  rc;
+  for (const auto & entry : byDigest) {
+    if (entry.second.size() > 1) {
+      set<pair<dev_t,ino_t>>  inodes;
+      DuplicateGroup  group;
+      group.digest = entry.first;
+      group.size = files[entry.second.front()].statbuf.st_size;
+      for (auto idx : entry.second) {
+        inodes.insert({files[idx].statbuf.st_dev, files[idx].statbuf.st_ino});
+        group.paths.push_back(files[idx].path);
+      }
+      group.duplicatedBytes = group.size * (inodes.size() - 1);
+      if (group.duplicatedBytes) {
+        rc.push_back(group);
+      }
+    }
   }
+  stable_sort(rc.begin(), rc.end(),
+              [] (const DuplicateGroup & a, const DuplicateGroup & b)
+              { return (a.duplicatedBytes > b.duplicatedBytes); });
   return rc;
 }
 
+//----------------------------------------------------------------------------
+//!  Prints a report of the staged files with duplicate contents, in the
+//!  given @c format ("text" or "json").
+//----------------------------------------------------------------------------
+static void ReportDuplicates(const vector<StagedFile> & files,
+                             const vector<string> & digests,
+                             const string & format, ostream & os)
+{
+  vector<DuplicateGroup>  groups = FindDuplicates(files, digests);
+  uint64_t  totalBytes = 0;
+  for (const auto & group : groups) {
+    totalBytes += group.duplicatedBytes;
+  }
+  if (format == "json") {
+    os << "{\n  \"groups\": [";
+    string  groupSep("\n");
+    for (const auto & group : groups) {
+      os << groupSep << "    {\"sha256\": \"" << group.digest << "\","
+         << " \"size\": " << group.size << ","
+         << " \"duplicated_bytes\": " << group.duplicatedBytes << ","
+         << " \"paths\": [";
+      string  pathSep;
+      for (const auto & path : group.paths) {
+        os << pathSep << '"' << JSONEscape(path) << '"';
+        pathSep = ", ";
+      }
+      os << "]}";
+      groupSep = ",\n";
+    }
+    os << (groups.empty() ? "]" : "\n  ]") << ",\n"
+       << "  \"total_duplicated_bytes\": " << totalBytes << "\n}\n";
+  }
+  else {
+    for (const auto & group : groups) {
+      os << group.duplicatedBytes << " duplicated bytes, "
+         << group.paths.size() << " paths of " << group.size
+         << " bytes, sha256 " << group.digest << '\n';
+      for (const auto & path : group.paths) {
+        os << "  " << path << '\n';
+      }
+    }
+    os << totalBytes << " duplicated bytes in " << groups.size()
+       << " groups\n";
+  }
+  return;
+}
+
 //----------------------------------------------------------------------------
 //!  
 //----------------------------------------------------------------------------
@@ -391,15 +687,14 @@ static string GetEscapedFileContents(const string & path)
   return rc;
 }
 
+typedef const string & (Manifest::*FieldSetFn)(const string & value);
+
 //----------------------------------------------------------------------------
-//!  Special files are those which we won't include in the manifest files
-//!  list, but will use to populate other fields in the manifest.
+//!  Returns the map of special files whose contents populate a field in
+//!  the manifest to the member function that sets the field.
 //----------------------------------------------------------------------------
-static bool HandleSpecialFile(const string & dirName, Manifest & manifest,
-                              const Manifest::File & mf)
+static const map<string,FieldSetFn> & SpecialFileSetters()
 {
-  bool  rc = false;
-  typedef const string & (Manifest::*FieldSetFn)(const string & value);
   static const map<string,FieldSetFn>  fieldSetters = {
     { "/+DESC",           &Manifest::Description },
     { "/+PRE_INSTALL",    &Manifest::PreInstall },
@@ -407,6 +702,27 @@ static bool HandleSpecialFile(const string & dirName, Manifest & manifest,
     { "/+PRE_DEINSTALL",  &Manifest::PreDeinstall },
     { "/+POST_DEINSTALL", &Manifest::PostDeinstall }
   };
+  return fieldSetters;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns true if @c path is one of the special files.
+//----------------------------------------------------------------------------
+static bool IsSpecialFile(const string & path)
+{
+  return ((path == "/+MANIFEST")
+          || (SpecialFileSetters().find(path) != SpecialFileSetters().end()));
+}
+
+//----------------------------------------------------------------------------
+//!  Special files are those which we won't include in the manifest files
+//!  list, but will use to populate other fields in the manifest.
+//----------------------------------------------------------------------------
+static bool HandleSpecialFile(const string & dirName, Manifest & manifest,
+                              const Manifest::File & mf)
+{
+  bool  rc = false;
+  const map<string,FieldSetFn>  & fieldSetters = SpecialFileSetters();
   auto  fs = fieldSetters.find(mf.Path());
   if (fs != fieldSetters.end()) {
     (manifest.*(fs->second))(GetEscapedFileContents(dirName + mf.Path()));
@@ -422,18 +738,25 @@ static bool HandleSpecialFile(const string & dirName, Manifest & manifest,
 //!  For any dependencies already in the manifest... if the version in
 //!  the manifest doesn't match the installed version, correct it.
 //----------------------------------------------------------------------------
-static void UpdatePackageDependencies(Manifest & manifest)
+static void UpdatePackageDependencies(PackageSource & packages,
+                                      Manifest & manifest)
 {
+  set<string>  names;
+  for (const auto & dep : manifest.Dependencies()) {
+    names.insert(dep.Name());
+  }
+  map<string,string>  installedVersions = packages.InstalledVersions(names);
   for (auto it = manifest.Dependencies().begin();
        it != manifest.Dependencies().end(); ++it) {
-    string  installedVersion =
-      GetInstalledPackageVersion(it->Name());
-    if ((! installedVersion.empty()) && (installedVersion != it->Version())) {
+    auto  iv = installedVersions.find(it->Name());
+    if ((iv != installedVersions.end()) && (! iv->second.empty())
+        && (iv->second != it->Version())) {
       cerr << it->Name() << " version corrected from "
-           << it->Version() << " to " << installedVersion << '\n';
-      it->Version(installedVersion);
+           << it->Version() << " to " << iv->second << '\n';
+      it->Version(iv->second);
     }
   }
+  return;
 }
 
 //----------------------------------------------------------------------------
@@ -446,76 +769,314 @@ static void
 CorrectDiscoveredDependencies(Manifest & manifest,
                               const vector<Manifest::Dependency> & discDeps)
 {
-  for (auto dep : discDeps) {
-    auto  it =
-      find_if(manifest.Dependencies().begin(),
-              manifest.Dependencies().end(),
-              [&] (const Manifest::Dependency & mdep) 
-              {
-                return ((dep.Name() == mdep.Name())
-                        && ((dep.Version() != mdep.Version())
-                            || (dep.Origin() != mdep.Origin())));
-              });
-    if (it != manifest.Dependencies().end()) {
-      if (dep.Version() != it->Version()) {
-        cerr << "Dependency version mismatch, " << dep.Name()
-             << " version corrected to " << dep.Version() << '\n';
+  //  Index the manifest's dependencies by name once.  A name may appear
+  //  more than once in a hand-written manifest, so keep every position.
+  vector<Manifest::Dependency>          & deps = manifest.Dependencies();
+  unordered_map<string,vector<size_t>>    byName;
+  for (size_t i = 0; i < deps.size(); ++i) {
+    byName[deps[i].Name()].push_back(i);
+  }
+  for (const auto & dep : discDeps) {
+    auto  nit = byName.find(dep.Name());
+    if (nit != byName.end()) {
+      auto  it = find_if(nit->second.begin(), nit->second.end(),
+                         [&] (size_t i)
+                         {
+                           return ((dep.Version() != deps[i].Version())
+                                   || (dep.Origin() != deps[i].Origin()));
+                         });
+      if (it != nit->second.end()) {
+        Manifest::Dependency  & mdep = deps[*it];
+        if (dep.Version() != mdep.Version()) {
+          cerr << "Dependency version mismatch, " << dep.Name()
+               << " version corrected to " << dep.Version() << '\n';
+        }
+        if (dep.Origin() != mdep.Origin()) {
+          cerr << "Dependency origin mismatch, " << dep.Name()
+               << " origin corrected to " << dep.Origin() << '\n';
+        }
+        mdep = dep;
+      }
+    }
+    else if (dep.Name() != manifest.Name()) {
+      cerr << "Added dependency " << dep.Name()
+           << " version " << dep.Version() << '\n';
+      byName[dep.Name()].push_back(deps.size());
+      deps.push_back(dep);
+    }
+  }
+  return;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns, for each member of @c roots, the members of @c targets that
+//!  can be reached from it in the installed dependency @c graph.  Paths
+//!  through @c skip (the package being built, whose installed version
+//!  may be older) are not followed.  The graph is indexed once and each
+//!  root is traversed once.
+//----------------------------------------------------------------------------
+static unordered_map<string,unordered_set<string>>
+ReachableTargets(const unordered_map<string,vector<string>> & graph,
+                 const set<string> & roots, const set<string> & targets,
+                 const string & skip)
+{
+  //  Number the packages so the traversals don't hash names.
+  unordered_map<string,size_t>  ids;
+  vector<const string *>        names;
+  auto  id = [&] (const string & name) {
+    auto  iit = ids.emplace(name, names.size());
+    if (iit.second) {
+      names.push_back(&(iit.first->first));
+    }
+    return iit.first->second;
+  };
+  vector<vector<size_t>>  edges(graph.size());
+  for (const auto & node : graph) {
+    size_t  from = id(node.first);
+    if (from >= edges.size()) {
+      edges.resize(from + 1);
+    }
+    for (const auto & dep : node.second) {
+      edges[from].push_back(id(dep));
+    }
+  }
+  vector<bool>  isTarget(names.size(), false);
+  for (const auto & target : targets) {
+    auto  iit = ids.find(target);
+    if (iit != ids.end()) {
+      isTarget[iit->second] = true;
+    }
+  }
+  auto  skipIt = ids.find(skip);
+
+  unordered_map<string,unordered_set<string>>  rc;
+  vector<size_t>  visited(names.size(), 0);
+  vector<size_t>  toVisit;
+  size_t          pass = 0;
+  for (const auto & root : roots) {
+    unordered_set<string>  & reached = rc[root];
+    auto  rit = ids.find(root);
+    if (rit == ids.end()) {
+      continue;
+    }
+    ++pass;
+    visited[rit->second] = pass;
+    if (skipIt != ids.end()) {
+      visited[skipIt->second] = pass;
+    }
+    toVisit.assign(1, rit->second);
+    while (! toVisit.empty()) {
+      size_t  node = toVisit.back();
+      toVisit.pop_back();
+      if (node < edges.size()) {
+        for (size_t dep : edges[node]) {
+          if (visited[dep] != pass) {
+            visited[dep] = pass;
+            if (isTarget[dep]) {
+              reached.insert(*(names[dep]));
+            }
+            toVisit.push_back(dep);
+          }
+        }
       }
-      if (dep.Origin() != it->Origin()) {
-        cerr << "Dependency origin mismatch, " << dep.Name()
-             << " origin corrected to " << dep.Origin() << '\n';
+    }
+  }
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns the first member of @c roots other than @c name from which
+//!  @c name can be reached according to @c reachable, or an empty string
+//!  if there is none.
+//----------------------------------------------------------------------------
+static string
+ImpliedBy(const unordered_map<string,unordered_set<string>> & reachable,
+          const set<string> & roots, const string & name)
+{
+  for (const auto & root : roots) {
+    if (root != name) {
+      auto  rit = reachable.find(root);
+      if ((rit != reachable.end())
+          && (rit->second.find(name) != rit->second.end())) {
+        return root;
       }
-      *it = dep;
-    }
-    if (find_if(manifest.Dependencies().begin(),
-                manifest.Dependencies().end(),
-                [&] (const Manifest::Dependency & mdep) 
-                {
-                  return (dep.Name() == mdep.Name());
-                })
-        == manifest.Dependencies().end()) {
-      if (dep.Name() != manifest.Name()) {
-        cerr << "Added dependency " << dep.Name()
-             << " version " << dep.Version() << '\n';
-        manifest.Dependencies().push_back(dep);
+    }
+  }
+  return string();
+}
+
+//----------------------------------------------------------------------------
+//!  Removes from @c discDeps the packages that aren't in the manifest yet
+//!  and are already required, directly or indirectly, by another
+//!  dependency, using the installed package dependency graph.  A package
+//!  only required through the installed version of the package being
+//!  built is kept.  Dependencies already in the manifest are never
+//!  removed.  Packages are removed one at a time, so of two packages
+//!  that require each other, one is kept.
+//----------------------------------------------------------------------------
+static void PruneImpliedDependencies(PackageSource & packages,
+                                     const Manifest & manifest,
+                                     vector<Manifest::Dependency> & discDeps)
+{
+  unordered_map<string,vector<string>>  graph = packages.DependencyGraph();
+  set<string>  listed;
+  for (const auto & dep : manifest.Dependencies()) {
+    listed.insert(dep.Name());
+  }
+  set<string>  roots(listed);
+  set<string>  candidates;
+  for (const auto & dep : discDeps) {
+    roots.insert(dep.Name());
+    if ((listed.find(dep.Name()) == listed.end())
+        && (dep.Name() != manifest.Name())) {
+      candidates.insert(dep.Name());
+    }
+  }
+  roots.erase(manifest.Name());
+  //  Removing a root doesn't change what the other roots reach, so the
+  //  reachable candidates of every root are found up front.
+  unordered_map<string,unordered_set<string>>  reachable =
+    ReachableTargets(graph, roots, candidates, manifest.Name());
+  for (auto it = discDeps.begin(); it != discDeps.end(); ) {
+    if (candidates.find(it->Name()) != candidates.end()) {
+      string  implier = ImpliedBy(reachable, roots, it->Name());
+      if (! implier.empty()) {
+        cerr << "Dependency " << it->Name() << " is required by "
+             << implier << ", not adding it\n";
+        roots.erase(it->Name());
+        it = discDeps.erase(it);
+        continue;
       }
     }
+    ++it;
   }
   return;
 }
 
 //----------------------------------------------------------------------------
-//!  Check for either mismatched package dependencies or missing dependencies
-//!  by looking for shared libraries in files in the given directory.
-//!  Patch up the dependencies if the version or origin is mismatched, add
-//!  them if they're missing from the manifest.
-//----------------------------------------------------------------------------
-static void ScanForPackageDependencies(const string & dirName,
-                                       Manifest & manifest)
-{
-  bool    rc = true;
-
-  set<string>  sharedLibs;
-  cerr << "Scanning " << dirName << " for dependencies\n";
-  for (auto & p : fs::recursive_directory_iterator(dirName)) {
-    if (fs::is_regular_file(p.path())) {
-      if ((fs::status(p.path()).permissions() & fs::perms::owner_exec)
-          != fs::perms::none) {
-        GetSharedLibs(p.path().string(), sharedLibs);;
+//!  Returns the real path of @c dirName, or @c dirName itself if it can't
+//!  be resolved.
+//----------------------------------------------------------------------------
+static string CanonicalDir(const string & dirName)
+{
+  string  rc(dirName);
+  char    *realDir = realpath(dirName.c_str(), nullptr);
+  if (realDir) {
+    rc = realDir;
+    free(realDir);
+  }
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  Walks the additional dependency scan directories @c dirNames
+//!  concurrently, one thread per directory, into @c scanTrees.
+//!  Directories whose real path is the staging directory's or that of an
+//!  earlier directory are skipped, so each directory is walked once.
+//!  Returns false if any of the walks failed.
+//----------------------------------------------------------------------------
+static bool WalkScanDirs(const StagingTree & stagingTree,
+                         const vector<string> & dirNames,
+                         vector<unique_ptr<StagingTree>> & scanTrees)
+{
+  set<string>  canonicalDirs = { CanonicalDir(stagingTree.DirName()) };
+  for (const auto & dirName : dirNames) {
+    if (canonicalDirs.insert(CanonicalDir(dirName)).second) {
+      scanTrees.push_back(make_unique<StagingTree>(dirName));
+    }
+  }
+  atomic<bool>    rc(true);
+  vector<thread>  walkers;
+  for (auto & scanTree : scanTrees) {
+    walkers.push_back(thread([&scanTree,&rc] () {
+      if (! scanTree->Walk(g_args.Get<'j'>())) {
+        rc = false;
       }
+    }));
+  }
+  for (auto & walker : walkers) {
+    walker.join();
+  }
+  return rc.load();
+}
+
+//----------------------------------------------------------------------------
+//!  Check for either mismatched package dependencies or missing dependencies
+//!  by looking for shared libraries and script interpreters needed by
+//!  files in the given trees.  All of the trees are scanned in one pass,
+//!  and a file reachable through more than one path (a hard link, or a
+//!  tree inside another) is scanned once.  The first tree is the staging
+//!  directory; if caches are in use (and the manifest isn't streamed),
+//!  the results for its files are kept in a dependency cache keyed by
+//!  @c stagedDigests, the digests computed for the staged files by this
+//!  run, so unchanged files aren't analyzed again.  The sums in a
+//!  template manifest are never used as keys, since they may belong to
+//!  an older file.  Patch up the dependencies
+//!  if the version or origin is mismatched, add them if they're missing
+//!  from the manifest.
+//----------------------------------------------------------------------------
+static void
+ScanForPackageDependencies(const vector<const StagingTree *> & trees,
+                           const unordered_map<string,string> & stagedDigests,
+                           PackageSource & packages, Manifest & manifest)
+{
+  const string  & stagingDir = trees.front()->DirName();
+  shared_ptr<Dwm::FreeBSDPkg::DependencyCache>  cache;
+  string  cachePath;
+  if (! g_args.Get<'S'>()) {
+    //  When streaming, the digests aren't known until after the scan.
+    cachePath = StagingCachePath(stagingDir, ".depcache");
+  }
+  if (! cachePath.empty()) {
+    cache = make_shared<Dwm::FreeBSDPkg::DependencyCache>(cachePath);
+    if (! cache->Load()) {
+      cerr << "Ignoring unreadable dependency cache " << cachePath << '\n';
     }
   }
-  if (! sharedLibs.empty()) {
-    set<pair<string,string>>  packageDeps;
-    GetPackageDeps(sharedLibs, packageDeps);
-    if (! packageDeps.empty()) {
-      vector<Manifest::Dependency>  dependencies;
-      GetPackageInfo(packageDeps, dependencies);
-      if (! dependencies.empty()) {
-        CorrectDiscoveredDependencies(manifest, dependencies);
+  
+  vector<DependencyScanner::File>  files;
+  set<pair<dev_t,ino_t>>           scannedFiles;
+  for (const auto tree : trees) {
+    cerr << "Scanning " << tree->DirName() << " for dependencies\n";
+    for (const auto & entry : tree->Entries()) {
+      if (S_ISREG(entry.statbuf.st_mode)
+          && scannedFiles.insert({entry.statbuf.st_dev,
+                                  entry.statbuf.st_ino}).second) {
+        files.push_back({tree->DirName() + entry.path,
+                         entry.statbuf.st_mode, string()});
+        if (cache && (tree == trees.front())) {
+          auto  it = stagedDigests.find(entry.path);
+          if (it != stagedDigests.end()) {
+            files.back().digest = it->second;
+          }
+        }
       }
     }
   }
+  DependencyScanner  scanner(g_args.Get<'j'>(), g_args.Get<'t'>());
+  scanner.Cache(cache);
+  set<string>        neededFiles = scanner.Scan(files);
+  for (const auto & path : scanner.TimedOut()) {
+    cerr << "Timed out after " << scanner.Timeout() << " seconds scanning "
+         << path << " for dependencies\n";
+  }
+  if (cache) {
+    cerr << "Dependency cache " << cachePath << ": " << cache->Hits()
+         << " hits, " << cache->Misses() << " misses\n";
+    if (! cache->Save()) {
+      cerr << "Failed to save dependency cache " << cachePath << '\n';
+    }
+  }
+  if (! neededFiles.empty()) {
+    vector<Manifest::Dependency>  dependencies =
+      packages.PackagesForFiles(neededFiles);
+    if (g_args.Get<'T'>() && (! dependencies.empty())) {
+      PruneImpliedDependencies(packages, manifest, dependencies);
+    }
+    if (! dependencies.empty()) {
+      CorrectDiscoveredDependencies(manifest, dependencies);
+    }
+  }
   return;
 }
 
@@ -537,15 +1098,44 @@ static map<char,string> ManifestFieldArgs()
 }
 
 //----------------------------------------------------------------------------
-//!  
+//!  Returns the paths of the files already listed in the manifest.
 //----------------------------------------------------------------------------
-bool PopulateManifest(const string & dirName, Manifest & manifest)
+static unordered_set<string> ListedPaths(const Manifest & manifest)
+{
+  unordered_set<string>  rc;
+  for (const auto & file : manifest.Files()) {
+    rc.insert(file.Path());
+  }
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns true if @c entry is a file that StreamManifest() writes to
+//!  the manifest after the files already listed in it (@c listed).
+//----------------------------------------------------------------------------
+static bool IsStreamedFile(const StagedFile & entry,
+                           const unordered_set<string> & listed)
+{
+  return (IsPackageFile(entry) && (! IsSpecialFile(entry.path))
+          && (listed.find(entry.path) == listed.end()));
+}
+
+//----------------------------------------------------------------------------
+//!  Sets the manifest fields from the command line and the special files,
+//!  and adds the files in the staging tree to the manifest.  If
+//!  @c streaming is true, files are not added to the manifest; they are
+//!  left for StreamManifest().  Otherwise the digest computed for each
+//!  staged file is put in @c stagedDigests, keyed by its path, including
+//!  the files whose entries in the template are kept.
+//----------------------------------------------------------------------------
+bool PopulateManifest(const StagingTree & stagingTree, Manifest & manifest,
+                      bool streaming,
+                      unordered_map<string,string> & stagedDigests)
 {
   //  All of the fields I want to set in a Manifest object can be set
   //  with a member function with the same signature.  So I can use a
   //  map of command line options to member functions in order to set
   //  the fields.
-  typedef const string & (Manifest::*FieldSetFn)(const string & value);
   static const map<char,FieldSetFn>  fieldSetters = {
     { 'n', &Manifest::Name },
     { 'v', &Manifest::Version },
@@ -558,8 +1148,47 @@ bool PopulateManifest(const string & dirName, Manifest & manifest)
   };
   
   bool  rc = false;
-  vector<Manifest::File>  manifestFiles = GetManifestFiles(dirName);
-  if (! manifestFiles.empty()) {
+  vector<Manifest::File>  manifestFiles;
+  size_t                  numStreamed = 0;
+  size_t                  numListed = 0;
+  if (streaming) {
+    //  Only the special files are needed now.
+    unordered_set<string>  listed = ListedPaths(manifest);
+    for (const auto & entry : stagingTree.Entries()) {
+      if (IsStreamedFile(entry, listed)) {
+        ++numStreamed;
+      }
+      else if (IsPackageFile(entry)) {
+        if (IsSpecialFile(entry.path)) {
+          manifestFiles.push_back(Manifest::File(entry.path));
+        }
+        else {
+          //  Listed in the template; written by StreamManifest().
+          ++numListed;
+        }
+      }
+    }
+  }
+  else {
+    manifestFiles = GetManifestFiles(stagingTree);
+    stagedDigests.reserve(manifestFiles.size());
+    for (const auto & mf : manifestFiles) {
+      if (! mf.SHA256().empty()) {
+        stagedDigests[mf.Path()] = mf.SHA256();
+      }
+    }
+    //  Files listed in the template keep their entries, but get the
+    //  digests computed now.  The template's sums may be stale, e.g.
+    //  if it's the output of an earlier run.
+    for (auto & file : manifest.Files()) {
+      const StagedFile  *entry = stagingTree.Find(file.Path());
+      if (entry && IsPackageFile(*entry)) {
+        auto  dit = stagedDigests.find(entry->path);
+        file.SHA256((dit != stagedDigests.end()) ? dit->second : string());
+      }
+    }
+  }
+  if ((! manifestFiles.empty()) || numStreamed || numListed) {
     map<char,string>  mnfstFieldArgs = ManifestFieldArgs();
     if (! mnfstFieldArgs.empty()) {
       for (auto mnfstField : mnfstFieldArgs) {
@@ -571,22 +1200,21 @@ bool PopulateManifest(const string & dirName, Manifest & manifest)
         }
       }
     }
-    set<string> sharedLibDeps;
-    
-    for (auto mfit : manifestFiles) {
-      //  Only add files that are not already in the manifest.
-      if (find_if(manifest.Files().begin(), manifest.Files().end(),
-                  [&mfit](Manifest::File const & item)
-                  { return item.Path() == mfit.Path(); })
-          == manifest.Files().end()) {
-        if (! HandleSpecialFile(dirName, manifest, mfit)) {
+    //  Only add files that are not already in the manifest.  The paths
+    //  listed in the template are indexed once, and each file added
+    //  below joins them.
+    unordered_set<string>  listed = ListedPaths(manifest);
+    manifest.Files().reserve(manifest.Files().size() + manifestFiles.size());
+    for (auto & mfit : manifestFiles) {
+      if (listed.insert(mfit.Path()).second) {
+        if (! HandleSpecialFile(stagingTree.DirName(), manifest, mfit)) {
           mfit.Group(g_args.Get<'g'>());
           mfit.User(g_args.Get<'u'>());
-          manifest.Files().push_back(mfit);
+          manifest.Files().push_back(std::move(mfit));
         }
       }
     }
-    if ((! manifest.Files().empty())
+    if (((! manifest.Files().empty()) || numStreamed)
         && (! manifest.Name().empty())
         && (! manifest.Version().empty())) {
       rc = true;
@@ -595,13 +1223,157 @@ bool PopulateManifest(const string & dirName, Manifest & manifest)
   return rc;
 }
 
+//----------------------------------------------------------------------------
+//!  Returns the files that are listed in the manifest but not present in
+//!  the staging tree.
+//----------------------------------------------------------------------------
+static vector<Manifest::File> MissingFiles(const Manifest & manifest,
+                                           const StagingTree & stagingTree)
+{
+  vector<Manifest::File>  missingFiles;
+  for (const auto & file : manifest.Files()) {
+    if (! stagingTree.Find(file.Path())) {
+      missingFiles.push_back(file);
+    }
+  }
+  return missingFiles;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns the total size of the regular files in the manifest, using
+//!  the sizes from the walk of the staging tree.  Like pkg-create(8), a
+//!  file with several hard links in the manifest is only counted once.
+//!  If @c streaming is true, the files StreamManifest() will add are
+//!  counted too.
+//----------------------------------------------------------------------------
+static size_t Flatsize(const Manifest & manifest,
+                       const StagingTree & stagingTree, bool streaming)
+{
+  size_t                  rc = 0;
+  set<pair<dev_t,ino_t>>  inodes;
+  auto  addSize = [&] (const StagedFile & entry) {
+    if (S_ISREG(entry.statbuf.st_mode)) {
+      if ((entry.statbuf.st_nlink < 2)
+          || inodes.insert({entry.statbuf.st_dev,
+                            entry.statbuf.st_ino}).second) {
+        rc += entry.statbuf.st_size;
+      }
+    }
+  };
+  for (const auto & file : manifest.Files()) {
+    const StagedFile  *entry = stagingTree.Find(file.Path());
+    if (entry) {
+      addSize(*entry);
+    }
+  }
+  if (streaming) {
+    unordered_set<string>  listed = ListedPaths(manifest);
+    for (const auto & entry : stagingTree.Entries()) {
+      if (IsStreamedFile(entry, listed)) {
+        addSize(entry);
+      }
+    }
+  }
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  Writes the manifest to @c os like operator <<, but hashes and writes
+//!  the files from the staging tree that aren't already in the manifest
+//!  in batches, so only one batch of digests is in memory at a time.
+//!  The files already in the manifest are written with the digests of
+//!  the staged files, not the template's sums.
+//----------------------------------------------------------------------------
+static void StreamManifest(const Manifest & manifest,
+                           const StagingTree & stagingTree, ostream & os)
+{
+  static const size_t  k_batchSize = 8192;
+
+  DigestState  digestState;
+  StartDigests(stagingTree.DirName(), digestState);
+  vector<StagedFile>  listedFiles;
+  vector<size_t>      listedIndices;
+  for (size_t i = 0; i < manifest.Files().size(); ++i) {
+    const StagedFile  *entry = stagingTree.Find(manifest.Files()[i].Path());
+    if (entry && IsPackageFile(*entry)) {
+      listedFiles.push_back(*entry);
+      listedIndices.push_back(i);
+    }
+  }
+  vector<string>  listedDigests = GetDigests(digestState, listedFiles);
+  
+  manifest.PrintHead(os);
+  Manifest::FilesWriter  filesWriter(os);
+  size_t  next = 0;
+  for (size_t i = 0; i < manifest.Files().size(); ++i) {
+    if ((next < listedIndices.size()) && (listedIndices[next] == i)) {
+      Manifest::File  file(manifest.Files()[i]);
+      file.SHA256(listedDigests[next++]);
+      filesWriter.Write(file);
+    }
+    else {
+      filesWriter.Write(manifest.Files()[i]);
+    }
+  }
+  
+  unordered_set<string>  listed = ListedPaths(manifest);
+  vector<StagedFile>     batch;
+  auto  writeBatch = [&] () {
+    vector<string>  digests = GetDigests(digestState, batch);
+    for (size_t i = 0; i < batch.size(); ++i) {
+      filesWriter.Write(Manifest::File(batch[i].path, digests[i],
+                                       g_args.Get<'u'>(), g_args.Get<'g'>()));
+    }
+    batch.clear();
+  };
+  for (const auto & entry : stagingTree.Entries()) {
+    if (IsStreamedFile(entry, listed)) {
+      batch.push_back(entry);
+      if (batch.size() >= k_batchSize) {
+        writeBatch();
+      }
+    }
+  }
+  if (! batch.empty()) {
+    writeBatch();
+  }
+  filesWriter.Close();
+  FinishDigests(digestState);
+  
+  manifest.PrintScripts(os);
+  return;
+}
+
 //----------------------------------------------------------------------------
 //!  
 //----------------------------------------------------------------------------
 int main(int argc, char *argv[])
 {
   InitArgs();
-  int  argind = g_args.Parse(argc, argv);
+  int       argind = g_args.Parse(argc, argv);
+  uint64_t  byteCount;
+  if (! ParseByteCount(g_args.Get<'M'>(), byteCount)) {
+    cerr << "Invalid size '" << g_args.Get<'M'>() << "' for -M\n";
+    argind = -1;
+  }
+  if ((! g_args.Get<'D'>().empty()) && (g_args.Get<'D'>() != "text")
+      && (g_args.Get<'D'>() != "json")) {
+    cerr << "Invalid report format '" << g_args.Get<'D'>() << "' for -D\n";
+    argind = -1;
+  }
+  PathFilter  pathFilter;
+  for (const auto & pattern : g_args.Get<'x'>()) {
+    pathFilter.Exclude(pattern);
+  }
+  for (const auto & pattern : g_args.Get<'i'>()) {
+    pathFilter.Include(pattern);
+  }
+  if ((! g_args.Get<'X'>().empty())
+      && (! pathFilter.Load(g_args.Get<'X'>()))) {
+    cerr << "Failed to read exclude patterns from " << g_args.Get<'X'>()
+         << ": " << strerror(errno) << '\n';
+    argind = -1;
+  }
   if (argind < 0) {
     cerr << g_args.Usage(argv[0], "[dependency_scan_path(s)...]");
     exit(1);
@@ -616,23 +1388,67 @@ int main(int argc, char *argv[])
   struct stat  statbuf;
   if (stat(g_args.Get<'s'>().c_str(), &statbuf) == 0) {
     if (statbuf.st_mode & S_IFDIR) {
-      //  Add files from directory argv[nextArg] to the manifest.
-      if (PopulateManifest(g_args.Get<'s'>(), manifest)) {
+      //  Walk the staging directory once.  Everything below works from
+      //  the resulting table instead of the filesystem.
+      StagingTree  stagingTree(g_args.Get<'s'>());
+      stagingTree.Filter(&pathFilter);
+      if (! stagingTree.Walk(g_args.Get<'j'>())) {
+        cerr << "Failed to walk " << g_args.Get<'s'>() << '\n';
+        return 1;
+      }
+      if (! g_args.Get<'D'>().empty()) {
+        //  Duplicate content report instead of a manifest.
+        vector<StagedFile>  files = GetFiles(stagingTree);
+        vector<string>      digests = GetDigests(g_args.Get<'s'>(), files);
+        ReportDuplicates(files, digests, g_args.Get<'D'>(), cout);
+        return 0;
+      }
+      //  Add files from the staging directory to the manifest.
+      unordered_map<string,string>  stagedDigests;
+      if (PopulateManifest(stagingTree, manifest, g_args.Get<'S'>(),
+                           stagedDigests)) {
+        //  One session with the package database for all of the lookups
+        //  below.
+        PackageDB                 packageDB;
+        unique_ptr<PackageCache>  packageCache;
+        if (packageDB.Open(g_args.Get<'P'>())) {
+          packageCache = AttachPackageCache(stagingTree.DirName(), packageDB);
+        }
         //  Update any dependencies that were already in the manifest, to
         //  match the installed version of the dependency.
-        UpdatePackageDependencies(manifest);
-        //  Scan for missing/mismatched dependencies in staging directory.
-        ScanForPackageDependencies(g_args.Get<'s'>(), manifest);
-        //  And then in any other directories given on the command line.
-        for ( ; argind < argc; ++argind) {
-          ScanForPackageDependencies(argv[argind], manifest);
+        UpdatePackageDependencies(packageDB, manifest);
+        //  Scan for missing/mismatched dependencies in the staging
+        //  directory and in any other directories given on the command
+        //  line, all at once.
+        vector<unique_ptr<StagingTree>>  scanTrees;
+        if (! WalkScanDirs(stagingTree, vector<string>(argv + argind,
+                                                       argv + argc),
+                           scanTrees)) {
+          cerr << "Failed to walk the dependency scan directories\n";
+          return 1;
+        }
+        vector<const StagingTree *>  trees = { &stagingTree };
+        for (const auto & scanTree : scanTrees) {
+          trees.push_back(scanTree.get());
+        }
+        ScanForPackageDependencies(trees, stagedDigests, packageDB,
+                                   manifest);
+        if (packageCache) {
+          FinishPackageCache(*packageCache);
         }
         //  Check for missing files.
         vector<Manifest::File>  missingFiles =
-          manifest.MissingFiles(g_args.Get<'s'>());
+          MissingFiles(manifest, stagingTree);
         if (missingFiles.empty()) {
           //  No missing files.  Emit the manifest.
-          cout << manifest;
+          manifest.Flatsize(Flatsize(manifest, stagingTree,
+                                     g_args.Get<'S'>()));
+          if (g_args.Get<'S'>()) {
+            StreamManifest(manifest, stagingTree, cout);
+          }
+          else {
+            cout << manifest;
+          }
           return 0;
         }
         else {
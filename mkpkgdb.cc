@@ -0,0 +1,416 @@
+//===========================================================================
+// @(#) $DwmPath$
+//===========================================================================
+//  Copyright (c) Daniel W. McRobb 2026
+//  All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions
+//  are met:
+//
+//  1. Redistributions of source code must retain the above copyright
+//     notice, this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//  3. The names of the authors and copyright holders may not be used to
+//     endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+//  IN NO EVENT SHALL DANIEL W. MCROBB BE LIABLE TO ANY PARTY FOR
+//  DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR CONSEQUENTIAL DAMAGES,
+//  INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS SOFTWARE,
+//  EVEN IF DANIEL W. MCROBB HAS BEEN ADVISED OF THE POSSIBILITY OF SUCH
+//  DAMAGE.
+//
+//  THE SOFTWARE PROVIDED HEREIN IS ON AN "AS IS" BASIS, AND
+//  DANIEL W. MCROBB HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+//  UPDATES, ENHANCEMENTS, OR MODIFICATIONS. DANIEL W. MCROBB MAKES NO
+//  REPRESENTATIONS AND EXTENDS NO WARRANTIES OF ANY KIND, EITHER
+//  IMPLIED OR EXPRESS, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+//  WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE,
+//  OR THAT THE USE OF THIS SOFTWARE WILL NOT INFRINGE ANY PATENT,
+//  TRADEMARK OR OTHER RIGHTS.
+//===========================================================================
+
+
+
+//---------------------------------------------------------------------------
+//!  \file mkpkgdb.cc
+//!  \brief Builds a synthetic pkg(8) local.sqlite for benchmarking and
+//!  testing dependency lookups away from a FreeBSD host.
+//---------------------------------------------------------------------------
+
+extern "C" {
+  #include <unistd.h>
+  #include <sqlite3.h>
+}
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "DwmArguments.hh"
+
+using namespace std;
+
+typedef   Dwm::Arguments<Dwm::Argument<'a',string>,
+                         Dwm::Argument<'d',unsigned int>,
+                         Dwm::Argument<'f',unsigned int>,
+                         Dwm::Argument<'n',unsigned int>,
+                         Dwm::Argument<'o',string,true>,
+                         Dwm::Argument<'s',unsigned int>> MyArgType;
+static MyArgType  g_args;
+
+//----------------------------------------------------------------------------
+//!  The tables and indices of the pkg database that matter to lookups,
+//!  modelled on the schema pkg(8) creates.
+//----------------------------------------------------------------------------
+static const char  *k_schema =
+  "create table packages ("
+  " id integer primary key, origin text not null, name text not null,"
+  " version text not null, comment text not null, desc text not null,"
+  " mtree_id integer, message text, arch text not null,"
+  " maintainer text not null, www text, prefix text not null,"
+  " flatsize integer not null, automatic integer not null,"
+  " locked integer not null default 0, licenselogic integer not null,"
+  " time integer, manifestdigest text null, pkg_format_version integer,"
+  " dep_formula text null, vital integer not null default 0);"
+  "create unique index packages_unique on packages(name);"
+  "create table files ("
+  " path text primary key, sha256 text,"
+  " package_id integer references packages(id) on delete cascade"
+  " on update cascade);"
+  "create index files_package on files(package_id);"
+  "create table deps ("
+  " origin text not null, name text not null, version text not null,"
+  " package_id integer references packages(id) on delete cascade"
+  " on update cascade, unique(package_id, name));"
+  "create index deps_package on deps(package_id);";
+
+static const vector<string>  k_categories = {
+  "archivers", "databases", "devel", "graphics", "lang", "math",
+  "multimedia", "net", "security", "sysutils", "textproc", "www", "x11"
+};
+
+static const vector<string>  k_syllables = {
+  "ba", "cor", "da", "el", "fi", "gen", "ho", "ix", "ja", "ka", "lib",
+  "mo", "nu", "ox", "py", "qu", "ro", "sa", "tk", "ul", "vi", "wa", "xo",
+  "yo", "ze"
+};
+
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+static void InitArgs()
+{
+  g_args.SetValueName<'a'>("paths_file");
+  g_args.SetHelp<'a'>("Also give ownership of the paths in the given file"
+                      " (one per line) to random packages, so lookups of"
+                      " files on this host find them");
+  g_args.SetValueName<'d'>("deps");
+  g_args.Set<'d'>(4);
+  g_args.SetHelp<'d'>("Average number of dependencies per package (default"
+                      " 4)");
+  g_args.SetValueName<'f'>("files");
+  g_args.Set<'f'>(40);
+  g_args.SetHelp<'f'>("Average number of files per package (default 40)");
+  g_args.SetValueName<'n'>("packages");
+  g_args.Set<'n'>(1000);
+  g_args.SetHelp<'n'>("Number of packages (default 1000)");
+  g_args.SetValueName<'o'>("file");
+  g_args.SetHelp<'o'>("Database file to create (replaced if it exists)");
+  g_args.SetValueName<'s'>("seed");
+  g_args.Set<'s'>(1);
+  g_args.SetHelp<'s'>("Random number seed (default 1).  The same arguments"
+                      " and seed always produce the same database.");
+}
+
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+struct Package
+{
+  string  name;
+  string  origin;
+  string  version;
+};
+
+//----------------------------------------------------------------------------
+//!  Returns a made-up but plausible package name.
+//----------------------------------------------------------------------------
+static string PackageName(mt19937 & rng)
+{
+  string  rc;
+  size_t  numSyllables = 2 + (rng() % 3);
+  for (size_t i = 0; i < numSyllables; ++i) {
+    rc += k_syllables[rng() % k_syllables.size()];
+  }
+  if ((rng() % 5) == 0) {
+    rc = "py39-" + rc;
+  }
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+static string Version(mt19937 & rng)
+{
+  string  rc = to_string(rng() % 10) + '.' + to_string(rng() % 30) + '.'
+    + to_string(rng() % 20);
+  if ((rng() % 4) == 0) {
+    rc += '_' + to_string(1 + (rng() % 5));
+  }
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+static string Sha256(mt19937 & rng)
+{
+  static const char  *hexDigits = "0123456789abcdef";
+  string  rc("1$");
+  for (int i = 0; i < 64; ++i) {
+    rc += hexDigits[rng() % 16];
+  }
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns the paths installed by the package @c pkg, @c numFiles of
+//!  them.  About a third of packages install shared libraries.
+//----------------------------------------------------------------------------
+static vector<string> PackageFiles(const Package & pkg, size_t numFiles,
+                                   mt19937 & rng)
+{
+  vector<string>  rc;
+  string          base("/usr/local");
+  if ((rng() % 3) == 0) {
+    string  lib(base + "/lib/lib" + pkg.name + ".so");
+    rc.push_back(lib);
+    rc.push_back(lib + '.' + to_string(1 + (rng() % 9)));
+    rc.push_back(base + "/lib/lib" + pkg.name + ".a");
+  }
+  if ((rng() % 2) == 0) {
+    rc.push_back(base + "/bin/" + pkg.name);
+  }
+  static const vector<string>  dirs = {
+    "/include/", "/share/", "/share/doc/", "/share/examples/", "/libexec/"
+  };
+  while (rc.size() < numFiles) {
+    rc.push_back(base + dirs[rng() % dirs.size()] + pkg.name + "/f"
+                 + to_string(rc.size()) + ((rng() % 2) ? ".h" : ".txt"));
+  }
+  rc.resize(numFiles);
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+static bool Exec(sqlite3 *db, const char *sql)
+{
+  char  *errmsg = nullptr;
+  if (sqlite3_exec(db, sql, nullptr, nullptr, &errmsg) != SQLITE_OK) {
+    cerr << "sqlite3_exec(\"" << sql << "\") failed: "
+         << (errmsg ? errmsg : "") << " {" << __FILE__ << ':' << __LINE__
+         << "}\n";
+    sqlite3_free(errmsg);
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+static sqlite3_stmt *Prepare(sqlite3 *db, const char *sql)
+{
+  sqlite3_stmt  *stmt = nullptr;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, 0) != SQLITE_OK) {
+    cerr << "sqlite3_prepare_v2(\"" << sql << "\") failed: "
+         << sqlite3_errmsg(db) << " {" << __FILE__ << ':' << __LINE__
+         << "}\n";
+    sqlite3_finalize(stmt);
+    stmt = nullptr;
+  }
+  return stmt;
+}
+
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+static void BindText(sqlite3_stmt *stmt, int col, const string & s)
+{
+  sqlite3_bind_text(stmt, col, s.c_str(), s.size(), SQLITE_TRANSIENT);
+  return;
+}
+
+//----------------------------------------------------------------------------
+//!  Steps @c stmt, which must not return rows, and resets it.  Returns
+//!  false on failure other than a duplicate path or dependency.
+//----------------------------------------------------------------------------
+static bool Step(sqlite3 *db, sqlite3_stmt *stmt)
+{
+  int  rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  if ((rc != SQLITE_DONE) && (rc != SQLITE_CONSTRAINT)) {
+    cerr << "sqlite3_step(\"" << sqlite3_sql(stmt) << "\") failed: "
+         << sqlite3_errmsg(db) << " {" << __FILE__ << ':' << __LINE__
+         << "}\n";
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+//!  Returns the number of rows in @c table.
+//----------------------------------------------------------------------------
+static int64_t RowCount(sqlite3 *db, const string & table)
+{
+  int64_t        rc = 0;
+  string         sql("select count(*) from " + table);
+  sqlite3_stmt  *stmt = Prepare(db, sql.c_str());
+  if (stmt) {
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      rc = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+  }
+  return rc;
+}
+
+//----------------------------------------------------------------------------
+//!  
+//----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  InitArgs();
+  int  argind = g_args.Parse(argc, argv);
+  if ((argind < 0) || (g_args.Get<'n'>() == 0)) {
+    cerr << g_args.Usage(argv[0]);
+    exit(1);
+  }
+  vector<string>  extraPaths;
+  if (! g_args.Get<'a'>().empty()) {
+    ifstream  is(g_args.Get<'a'>().c_str());
+    if (! is) {
+      cerr << "Failed to open " << g_args.Get<'a'>() << '\n';
+      exit(1);
+    }
+    string  line;
+    while (getline(is, line)) {
+      if (! line.empty()) {
+        extraPaths.push_back(line);
+      }
+    }
+  }
+  
+  const string  & dbPath = g_args.Get<'o'>();
+  unlink(dbPath.c_str());
+  sqlite3  *db = nullptr;
+  if (sqlite3_open_v2(dbPath.c_str(), &db,
+                      SQLITE_OPEN_READWRITE|SQLITE_OPEN_CREATE, 0)
+      != SQLITE_OK) {
+    cerr << "sqlite3_open_v2(\"" << dbPath << "\") failed {"
+         << __FILE__ << ':' << __LINE__ << "}\n";
+    exit(1);
+  }
+  if (! (Exec(db, "pragma journal_mode = off; pragma synchronous = off")
+         && Exec(db, k_schema) && Exec(db, "begin"))) {
+    sqlite3_close_v2(db);
+    exit(1);
+  }
+  sqlite3_stmt  *pkgStmt = Prepare(db,
+    "insert into packages (id, origin, name, version, comment, desc, arch,"
+    " maintainer, www, prefix, flatsize, automatic, licenselogic, time)"
+    " values (?1, ?2, ?3, ?4, ?5, ?6, 'FreeBSD:13:amd64',"
+    " 'ports@FreeBSD.org', ?7, '/usr/local', ?8, ?9, 1, ?10)");
+  sqlite3_stmt  *fileStmt = Prepare(db,
+    "insert into files (path, sha256, package_id) values (?1, ?2, ?3)");
+  sqlite3_stmt  *depStmt = Prepare(db,
+    "insert into deps (origin, name, version, package_id)"
+    " values (?1, ?2, ?3, ?4)");
+  if ((! pkgStmt) || (! fileStmt) || (! depStmt)) {
+    exit(1);
+  }
+
+  mt19937                       rng(g_args.Get<'s'>());
+  exponential_distribution<>    numFiles(1.0 / g_args.Get<'f'>());
+  exponential_distribution<>    numDeps(1.0 / (g_args.Get<'d'>() + 0.001));
+  vector<Package>               packages;
+  set<string>                   names;
+  bool                          ok = true;
+  
+  for (unsigned int id = 1; ok && (id <= g_args.Get<'n'>()); ++id) {
+    Package  pkg;
+    pkg.name = PackageName(rng);
+    if (! names.insert(pkg.name).second) {
+      pkg.name += to_string(id);
+      names.insert(pkg.name);
+    }
+    pkg.origin = k_categories[rng() % k_categories.size()] + '/' + pkg.name;
+    pkg.version = Version(rng);
+    sqlite3_bind_int64(pkgStmt, 1, id);
+    BindText(pkgStmt, 2, pkg.origin);
+    BindText(pkgStmt, 3, pkg.name);
+    BindText(pkgStmt, 4, pkg.version);
+    BindText(pkgStmt, 5, "The " + pkg.name + " package");
+    BindText(pkgStmt, 6, "A synthetic package named " + pkg.name + '.');
+    BindText(pkgStmt, 7, "https://www.example.com/" + pkg.name);
+    sqlite3_bind_int64(pkgStmt, 8, rng() % 100000000);
+    sqlite3_bind_int(pkgStmt, 9, (rng() % 2));
+    sqlite3_bind_int64(pkgStmt, 10, 1600000000 + (rng() % 100000000));
+    ok = Step(db, pkgStmt);
+
+    size_t  fileCount = 1 + (size_t)numFiles(rng);
+    for (const auto & path : PackageFiles(pkg, fileCount, rng)) {
+      BindText(fileStmt, 1, path);
+      BindText(fileStmt, 2, Sha256(rng));
+      sqlite3_bind_int64(fileStmt, 3, id);
+      ok = ok && Step(db, fileStmt);
+    }
+    
+    //  Dependencies only point at earlier packages, so there are no
+    //  cycles, like a real package set.
+    size_t  depCount = min((size_t)numDeps(rng), packages.size());
+    for (size_t i = 0; ok && (i < depCount); ++i) {
+      const Package  & dep = packages[rng() % packages.size()];
+      BindText(depStmt, 1, dep.origin);
+      BindText(depStmt, 2, dep.name);
+      BindText(depStmt, 3, dep.version);
+      sqlite3_bind_int64(depStmt, 4, id);
+      ok = Step(db, depStmt);
+    }
+    packages.push_back(pkg);
+  }
+  for (size_t i = 0; ok && (i < extraPaths.size()); ++i) {
+    BindText(fileStmt, 1, extraPaths[i]);
+    BindText(fileStmt, 2, Sha256(rng));
+    sqlite3_bind_int64(fileStmt, 3, 1 + (rng() % packages.size()));
+    ok = Step(db, fileStmt);
+  }
+  
+  sqlite3_finalize(pkgStmt);
+  sqlite3_finalize(fileStmt);
+  sqlite3_finalize(depStmt);
+  ok = ok && Exec(db, "commit") && Exec(db, "analyze");
+  if (ok) {
+    cerr << dbPath << ": " << RowCount(db, "packages") << " packages, "
+         << RowCount(db, "files") << " files, " << RowCount(db, "deps")
+         << " dependencies\n";
+  }
+  sqlite3_close_v2(db);
+  if (! ok) {
+    unlink(dbPath.c_str());
+    return 1;
+  }
+  return 0;
+}